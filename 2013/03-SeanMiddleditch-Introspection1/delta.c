@@ -0,0 +1,159 @@
+// Copyright (C) 2013 Sean Middleditch.  All right reserved.
+// DigiPen Institute of Technology - Game Engine Architecture Club
+// Do not use this code for any purpose besides study.  Besides
+// me not giving you permission, only a lame programmer would use
+// this for anything even remotely production quality.
+
+#include "meta.h"
+
+#include <string.h>
+#include <assert.h>
+
+#define MASK_BITS (sizeof(unsigned) * 8)
+
+static unsigned mask_words(const meta* meta)
+{
+	return (meta->layout_count + MASK_BITS - 1) / MASK_BITS;
+}
+
+static unsigned value_size(meta_type type)
+{
+	return type == MT_STRING ? sizeof(unsigned) : meta_type_size(type);
+}
+
+// the delta buffer has no alignment requirement, so mask words are copied
+static unsigned mask_get(const char* mask, unsigned word)
+{
+	unsigned bits;
+	memcpy(&bits, mask + word * sizeof(unsigned), sizeof(bits));
+	return bits;
+}
+
+static void mask_set(char* mask, unsigned i)
+{
+	unsigned bits = mask_get(mask, i / MASK_BITS) | 1u << (i % MASK_BITS);
+	memcpy(mask + i / MASK_BITS * sizeof(unsigned), &bits, sizeof(bits));
+}
+
+static int attr_equal(const meta_attribute* attr, const char* a, const char* b)
+{
+	switch (attr->type)
+	{
+	case MT_SINT32:
+	case MT_FLOAT:
+		// compare the bits, not the values, so -0.0f and NaNs still replicate
+		return 0 == memcmp(a, b, meta_type_size(attr->type));
+	case MT_STRING:
+	{
+		// strings are interned, so equal strings share a pointer
+		const char* sa;
+		const char* sb;
+		memcpy(&sa, a, sizeof(sa));
+		memcpy(&sb, b, sizeof(sb));
+		return sa == sb;
+	}
+	default:
+		assert(false && "unknown type");
+		return 1;
+	}
+}
+
+unsigned meta_delta_max_size(const meta* meta)
+{
+	assert(meta != NULL);
+	unsigned size = mask_words(meta) * sizeof(unsigned);
+	for (unsigned i = 0; i != meta->layout_count; ++i)
+		size += value_size(meta->layout[i]->type);
+	return size;
+}
+
+unsigned meta_diff(const meta* meta, const void* from, const void* to, void* delta)
+{
+	assert(meta != NULL && from != NULL && to != NULL && delta != NULL);
+	if (meta->layout_count == 0)
+		return 0;
+
+	const char* a = (const char*)from;
+	const char* b = (const char*)to;
+
+	// the layout is sorted by offset, so one compare over the whole span
+	// rejects the common unchanged case; padding may cause false mismatches,
+	// which are caught by the per-attribute compare below
+	const meta_attribute* first = meta->layout[0];
+	const meta_attribute* last = meta->layout[meta->layout_count - 1];
+	unsigned span = last->offset + meta_type_size(last->type) - first->offset;
+	if (0 == memcmp(a + first->offset, b + first->offset, span))
+		return 0;
+
+	unsigned words = mask_words(meta);
+	char* mask = (char*)delta;
+	char* out = mask + words * sizeof(unsigned);
+	memset(mask, 0, words * sizeof(unsigned));
+
+	for (unsigned i = 0; i != meta->layout_count; ++i)
+	{
+		const meta_attribute* attr = meta->layout[i];
+		if (attr_equal(attr, a + attr->offset, b + attr->offset))
+			continue;
+
+		mask_set(mask, i);
+		if (attr->type == MT_STRING)
+		{
+			// a string assigned directly rather than through meta_set is not
+			// interned yet and has no index until it is
+			const char* str;
+			memcpy(&str, b + attr->offset, sizeof(str));
+			if (!meta_string_is_interned(str))
+				str = meta_intern(str);
+			unsigned index = meta_string_index(str);
+			memcpy(out, &index, sizeof(index));
+			out += sizeof(index);
+		}
+		else
+		{
+			unsigned size = meta_type_size(attr->type);
+			memcpy(out, b + attr->offset, size);
+			out += size;
+		}
+	}
+
+	// only padding differed
+	if (out == mask + words * sizeof(unsigned))
+		return 0;
+
+	return (unsigned)(out - (char*)delta);
+}
+
+void meta_patch(const meta* meta, void* object, const void* delta)
+{
+	assert(meta != NULL && object != NULL && delta != NULL);
+
+	unsigned words = mask_words(meta);
+	const char* mask = (const char*)delta;
+	const char* in = mask + words * sizeof(unsigned);
+
+	for (unsigned w = 0; w != words; ++w)
+	{
+		unsigned bits = mask_get(mask, w);
+		for (unsigned i = w * MASK_BITS; bits != 0; ++i, bits >>= 1)
+		{
+			if ((bits & 1) == 0)
+				continue;
+
+			const meta_attribute* attr = meta->layout[i];
+			if (attr->type == MT_STRING)
+			{
+				unsigned index;
+				memcpy(&index, in, sizeof(index));
+				*(const char**)((char*)object + attr->offset) = meta_string_at(index);
+				in += sizeof(index);
+			}
+			else
+			{
+				unsigned size = meta_type_size(attr->type);
+				memcpy((char*)object + attr->offset, in, size);
+				in += size;
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,347 @@
+// Copyright (C) 2013 Sean Middleditch.  All right reserved.
+// DigiPen Institute of Technology - Game Engine Architecture Club
+// Do not use this code for any purpose besides study.  Besides
+// me not giving you permission, only a lame programmer would use
+// this for anything even remotely production quality.
+
+#include "meta.h"
+
+#include <string.h>
+#include <assert.h>
+
+// a table is one contiguous block: header, hash index, string bytes.
+// it holds no pointers, only offsets, so it can be saved and mapped back.
+// the strings live in a chain of tables: an optional attached table, which
+// is never written, then owned tables of growing size. only the last table
+// takes new strings, so string indices run on from one table to the next
+// and a string never moves once interned.
+typedef struct string_table string_table;
+typedef struct string_slot string_slot;
+typedef struct string_block string_block;
+
+struct string_table
+{
+	unsigned magic;
+	unsigned buckets; // power of two
+	unsigned capacity; // bytes available for string data
+	unsigned used; // bytes of string data in use
+	unsigned count; // number of strings
+};
+
+struct string_slot
+{
+	unsigned hash;
+	unsigned index; // offset of the string plus one, 0 for an empty slot
+};
+
+struct string_block
+{
+	string_table* table;
+	unsigned base; // index of the first string byte within the whole chain
+	unsigned size; // bytes of the block
+	unsigned capacity; // may be less than table->capacity for a saved block
+	int owned; // allocated here and freed by meta_strings_clear
+	int writable; // new strings may be added
+};
+
+#define TABLE_MAGIC 0x4D535452u // "MSTR"
+#define DEFAULT_SIZE (64 * 1024)
+#define MAX_SIZE (1u << 30)
+#define MAX_BLOCKS 32
+
+static string_block s_blocks[MAX_BLOCKS];
+static unsigned s_block_count = 0;
+
+static string_slot* table_slots(string_table* table)
+{
+	return (string_slot*)(table + 1);
+}
+
+static char* table_data(string_table* table)
+{
+	return (char*)(table_slots(table) + table->buckets);
+}
+
+static unsigned table_header(string_table* table)
+{
+	return (unsigned)(table_data(table) - (char*)table);
+}
+
+static unsigned hash_string(const char* str)
+{
+	// FNV-1a
+	unsigned hash = 2166136261u;
+	while (*str != 0)
+		hash = (hash ^ (unsigned char)*str++) * 16777619u;
+	return hash;
+}
+
+static string_table* table_format(void* block, unsigned size)
+{
+	string_table* table = (string_table*)block;
+
+	// spend about a quarter of the block on the index
+	unsigned buckets = 1;
+	while (buckets * 2 * sizeof(string_slot) * 4 <= size)
+		buckets *= 2;
+
+	table->magic = TABLE_MAGIC;
+	table->buckets = buckets;
+	table->capacity = size - sizeof(string_table) - buckets * sizeof(string_slot);
+	table->used = 0;
+	table->count = 0;
+	memset(table_slots(table), 0, buckets * sizeof(string_slot));
+	return table;
+}
+
+static string_block* add_block(string_table* table, unsigned size, unsigned capacity, int owned, int writable)
+{
+	if (s_block_count == MAX_BLOCKS)
+		return 0;
+
+	string_block* block = &s_blocks[s_block_count];
+	if (s_block_count != 0)
+	{
+		// the previous table is closed so indices stay contiguous
+		string_block* last = &s_blocks[s_block_count - 1];
+		last->writable = 0;
+		block->base = last->base + last->table->used;
+	}
+	else
+		block->base = 0;
+
+	block->table = table;
+	block->size = size;
+	block->capacity = capacity;
+	block->owned = owned;
+	block->writable = writable;
+	++s_block_count;
+	return block;
+}
+
+// allocates a table twice the size of the last owned one, large enough for len bytes
+static string_block* grow(unsigned len)
+{
+	unsigned size = DEFAULT_SIZE;
+	for (unsigned i = s_block_count; i-- != 0;)
+	{
+		if (s_blocks[i].owned)
+		{
+			size = s_blocks[i].size <= MAX_SIZE / 2 ? s_blocks[i].size * 2 : MAX_SIZE;
+			break;
+		}
+	}
+	while (size / 2 < len + sizeof(string_table) && size <= MAX_SIZE / 2)
+		size *= 2;
+	if (size / 2 < len + sizeof(string_table) || s_block_count == MAX_BLOCKS)
+		return 0;
+
+	void* memory = malloc(size);
+	if (memory == NULL)
+		return 0;
+
+	string_table* table = table_format(memory, size);
+	return add_block(table, size, table->capacity, 1, 1);
+}
+
+static const char* block_find(const string_block* block, const char* str, unsigned hash)
+{
+	string_slot* slots = table_slots(block->table);
+	char* data = table_data(block->table);
+	unsigned mask = block->table->buckets - 1;
+
+	for (unsigned i = hash & mask; slots[i].index != 0; i = (i + 1) & mask)
+		if (slots[i].hash == hash && 0 == strcmp(data + slots[i].index - 1, str))
+			return data + slots[i].index - 1;
+	return 0;
+}
+
+static int block_fits(const string_block* block, unsigned len)
+{
+	// keep the index at most 3/4 full so probes stay short
+	const string_table* table = block->table;
+	return block->writable && table->used + len <= block->capacity && (table->count + 1) * 4 <= table->buckets * 3;
+}
+
+static const char* block_insert(string_block* block, const char* str, unsigned hash, unsigned len)
+{
+	string_table* table = block->table;
+	string_slot* slots = table_slots(table);
+	char* data = table_data(table);
+	unsigned mask = table->buckets - 1;
+
+	unsigned i = hash & mask;
+	while (slots[i].index != 0)
+		i = (i + 1) & mask;
+
+	memcpy(data + table->used, str, len);
+	slots[i].hash = hash;
+	slots[i].index = table->used + 1;
+	table->used += len;
+	++table->count;
+	return data + slots[i].index - 1;
+}
+
+static const string_block* find_block(const char* str)
+{
+	for (unsigned i = 0; i != s_block_count; ++i)
+	{
+		const string_block* block = &s_blocks[i];
+		const char* data = table_data(block->table);
+		if (str >= data && str < data + block->table->used)
+			return block;
+	}
+	return 0;
+}
+
+int meta_strings_init(void* block, unsigned size)
+{
+	assert(block != NULL && size > sizeof(string_table) + sizeof(string_slot));
+	assert(s_block_count == 0 && "strings were already interned");
+	if (s_block_count != 0)
+		return 0;
+
+	string_table* table = table_format(block, size);
+	add_block(table, size, table->capacity, 0, 1);
+	return 1;
+}
+
+int meta_strings_attach(const void* block, unsigned size)
+{
+	assert(block != NULL);
+	assert(s_block_count == 0 && "strings were already interned");
+	if (s_block_count != 0 || size < sizeof(string_table))
+		return 0;
+
+	string_table* table = (string_table*)block;
+	if (table->magic != TABLE_MAGIC || table->buckets == 0 || (table->buckets & (table->buckets - 1)) != 0 ||
+		table->count >= table->buckets || table->buckets > (size - sizeof(string_table)) / sizeof(string_slot))
+		return 0;
+
+	unsigned header = table_header(table);
+	if (size - header < table->used)
+		return 0; // truncated
+
+	// the table is read in place, so every string must lie within it
+	const string_slot* slots = table_slots(table);
+	for (unsigned i = 0; i != table->buckets; ++i)
+		if (slots[i].index > table->used)
+			return 0;
+	if (table->used != 0 && table_data(table)[table->used - 1] != 0)
+		return 0;
+
+	add_block(table, size, table->used, 0, 0);
+	return 1;
+}
+
+unsigned meta_strings_save(void* block, unsigned size)
+{
+	unsigned used = 0;
+	unsigned count = 0;
+	for (unsigned i = 0; i != s_block_count; ++i)
+	{
+		used += s_blocks[i].table->used;
+		count += s_blocks[i].table->count;
+	}
+
+	unsigned buckets = 1;
+	while ((count + 1) * 4 > buckets * 3)
+		buckets *= 2;
+
+	unsigned total = (unsigned)sizeof(string_table) + buckets * (unsigned)sizeof(string_slot) + used;
+	if (block == NULL || size < total)
+		return total;
+
+	string_table* table = (string_table*)block;
+	table->magic = TABLE_MAGIC;
+	table->buckets = buckets;
+	table->capacity = used;
+	table->used = used;
+	table->count = count;
+
+	string_slot* slots = table_slots(table);
+	char* data = table_data(table);
+	memset(slots, 0, buckets * sizeof(string_slot));
+
+	// the data is copied in chain order, so every index stays the same
+	for (unsigned b = 0; b != s_block_count; ++b)
+	{
+		string_block* from = &s_blocks[b];
+		string_slot* old = table_slots(from->table);
+		memcpy(data + from->base, table_data(from->table), from->table->used);
+		for (unsigned i = 0; i != from->table->buckets; ++i)
+		{
+			if (old[i].index == 0)
+				continue;
+			unsigned j = old[i].hash & (buckets - 1);
+			while (slots[j].index != 0)
+				j = (j + 1) & (buckets - 1);
+			slots[j].hash = old[i].hash;
+			slots[j].index = old[i].index + from->base;
+		}
+	}
+	return total;
+}
+
+void meta_strings_clear(void)
+{
+	for (unsigned i = 0; i != s_block_count; ++i)
+		if (s_blocks[i].owned)
+			free(s_blocks[i].table);
+	s_block_count = 0;
+}
+
+const char* meta_intern(const char* str)
+{
+	if (str == NULL)
+		return 0;
+
+	unsigned hash = hash_string(str);
+	for (unsigned i = 0; i != s_block_count; ++i)
+	{
+		const char* found = block_find(&s_blocks[i], str, hash);
+		if (found != NULL)
+			return found;
+	}
+
+	unsigned len = (unsigned)strlen(str) + 1;
+	string_block* last = s_block_count != 0 ? &s_blocks[s_block_count - 1] : 0;
+	if (last == NULL || !block_fits(last, len))
+		last = grow(len);
+	if (last == NULL)
+	{
+		assert(false && "out of memory for strings");
+		return 0;
+	}
+	return block_insert(last, str, hash, len);
+}
+
+int meta_string_is_interned(const char* str)
+{
+	return str == NULL || find_block(str) != NULL;
+}
+
+unsigned meta_string_index(const char* interned)
+{
+	if (interned == NULL)
+		return 0;
+	const string_block* block = find_block(interned);
+	assert(block != NULL && "string is not interned");
+	if (block == NULL)
+		return 0;
+	return block->base + (unsigned)(interned - table_data(block->table)) + 1;
+}
+
+const char* meta_string_at(unsigned index)
+{
+	if (index == 0)
+		return 0;
+	for (unsigned i = 0; i != s_block_count; ++i)
+	{
+		const string_block* block = &s_blocks[i];
+		if (index > block->base && index <= block->base + block->table->used)
+			return table_data(block->table) + index - 1 - block->base;
+	}
+	assert(false && "string index is out of range");
+	return 0;
+}
@@ -7,6 +7,7 @@
 #include "test.h"
 
 #include <assert.h>
+#include <stdio.h>
 
 int main()
 {
@@ -65,6 +66,16 @@ int main()
 
 	meta_get(attr, &d2, &s);
 	assert(0 == strcmp("key", d2._base.last_input));
+	assert(s == meta_intern("key"));
+
+	char buffer[8];
+	strcpy(buffer, "other");
+	meta_set(attr, &d2, &s);
+	assert(d2._base.last_input == meta_intern("key"));
+	s = buffer;
+	meta_set(attr, &d2, &s);
+	assert(d2._base.last_input != buffer && d2._base.last_input == meta_intern("other"));
+	assert(meta_string_at(meta_string_index(d2._base.last_input)) == d2._base.last_input);
 
 	meta = meta_find("TestDerived1");
 	d1.health = 100;
@@ -83,5 +94,61 @@ int main()
 
 	assert(49 == i);
 
+	d1._base.last_input = NULL;
+	d1._base.counter = 0;
+	TestDerived1 d1b = d1;
+	char delta[64];
+	assert(meta_delta_max_size(meta) <= sizeof(delta));
+	assert(0 == meta_diff(meta, &d1, &d1b, delta));
+
+	d1b.damage = 5;
+	d1b._base.counter = 9;
+	d1b._base.last_input = meta_intern("fire");
+	unsigned size = meta_diff(meta, &d1, &d1b, delta);
+	assert(size == sizeof(unsigned) + 3 * sizeof(int));
+
+	meta_patch(meta, &d1, delta);
+	assert(5 == d1.damage && 9 == d1._base.counter && 49 == d1.health);
+	assert(d1._base.last_input == meta_intern("fire"));
+	assert(0 == meta_diff(meta, &d1, &d1b, delta));
+
+	// a string assigned directly is interned when encoded, into a misaligned buffer
+	char literal[] = "direct";
+	char unaligned[sizeof(delta) + 1];
+	d1b._base.last_input = literal;
+	size = meta_diff(meta, &d1, &d1b, unaligned + 1);
+	assert(size == 2 * sizeof(unsigned));
+	meta_patch(meta, &d1, unaligned + 1);
+	assert(d1._base.last_input == meta_intern("direct"));
+
+	// fill several blocks; earlier strings keep their address and index
+	const char* fire = meta_intern("fire");
+	unsigned index = meta_string_index(fire);
+	char name[16];
+	for (int n = 0; n != 20000; ++n)
+	{
+		sprintf(name, "input%d", n);
+		const char* str = meta_intern(name);
+		assert(str != NULL && 0 == strcmp(name, str) && meta_string_at(meta_string_index(str)) == str);
+	}
+	assert(meta_intern("fire") == fire && meta_string_at(index) == fire);
+	assert(meta_string_is_interned(fire) && !meta_string_is_interned(name));
+
+	unsigned block_size = meta_strings_save(NULL, 0);
+	void* saved = malloc(block_size);
+	assert(block_size == meta_strings_save(saved, block_size));
+	meta_strings_clear();
+	assert(meta_strings_attach(saved, block_size));
+	assert(0 == strcmp("fire", meta_string_at(index)));
+	assert(meta_intern("fire") == meta_string_at(index));
+	assert(0 == strcmp("input19999", meta_intern("input19999")));
+
+	// new strings go to an owned block after the read-only one
+	const char* fresh = meta_intern("fresh");
+	assert(meta_string_index(fresh) > index && meta_string_at(meta_string_index(fresh)) == fresh);
+	meta_strings_clear();
+	assert(!meta_strings_attach(saved, block_size / 2));
+	free(saved);
+
 	return 0;
 }
@@ -11,9 +11,53 @@
 
 static meta* s_head = 0;
 
+static void meta_build_layout(meta* meta)
+{
+	const struct meta* m = meta;
+	const meta_attribute* a;
+	unsigned count = 0;
+	unsigned j;
+
+	// the super's members live at the front of the object, so inherited
+	// offsets are valid as-is for the deriving type
+	for (;;)
+	{
+		for (a = m->attrs; a != 0; a = a->next)
+			++count;
+		if (m->super == m)
+			break;
+		assert(m->super->name != NULL && "super must be initialized first");
+		m = m->super;
+	}
+
+	meta->layout_count = count;
+	meta->layout = 0;
+	if (count == 0)
+		return;
+
+	meta->layout = (const meta_attribute**)malloc(count * sizeof(const meta_attribute*));
+	assert(meta->layout != NULL);
+
+	count = 0;
+	for (m = meta;; m = m->super)
+	{
+		for (a = m->attrs; a != 0; a = a->next)
+		{
+			// insertion sort by offset; attribute lists are tiny
+			for (j = count; j > 0 && meta->layout[j - 1]->offset > a->offset; --j)
+				meta->layout[j] = meta->layout[j - 1];
+			meta->layout[j] = a;
+			++count;
+		}
+		if (m->super == m)
+			break;
+	}
+}
+
 void meta_add(meta* meta)
 {
 	assert(meta != NULL);
+	meta_build_layout(meta);
 	meta->next = s_head;
 	s_head = meta;
 }
@@ -85,6 +129,17 @@ const meta_event* meta_find_event(const meta* meta, const char* name)
 		return 0;
 }
 
+unsigned meta_type_size(meta_type type)
+{
+	switch (type)
+	{
+	case MT_SINT32: return sizeof(int);
+	case MT_FLOAT: return sizeof(float);
+	case MT_STRING: return sizeof(const char*);
+	default: return 0;
+	}
+}
+
 void meta_get(const meta_attribute* attr, const void* object, void* buffer)
 {
 	assert(attr != NULL && object != NULL && buffer != NULL);
@@ -116,7 +171,7 @@ void meta_set(const meta_attribute* attr, void* object, const void* buffer)
 		*(float*)((char*)object + attr->offset) = *(const float*)buffer;
 		break;
 	case MT_STRING:
-		*(const char**)((char*)object + attr->offset) = *(const char**)buffer;
+		*(const char**)((char*)object + attr->offset) = meta_intern(*(const char**)buffer);
 		break;
 	default:
 		assert(false && "unknown type");
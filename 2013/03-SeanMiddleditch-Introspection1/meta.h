@@ -29,6 +29,8 @@ struct meta
 	unsigned size;
 	meta_attribute* attrs;
 	meta_event* events;
+	const meta_attribute** layout; // all attributes including inherited ones, sorted by offset
+	unsigned layout_count;
 };
 
 struct meta_attribute
@@ -62,6 +64,34 @@ void meta_get(const meta_attribute* attr, const void* object, void* buffer);
 void meta_set(const meta_attribute* attr, void* object, const void* buffer);
 void meta_call(const meta_event* event, void* object, const void* message);
 
+unsigned meta_type_size(meta_type type);
+
+// MT_STRING attributes hold strings interned in a string table, so equal
+// strings are equal pointers and an interned string never moves; the table
+// grows by chaining blocks and numbers every string with a stable index.
+// meta_strings_init supplies the first block and meta_strings_attach maps a
+// saved table back read-only; both must precede any meta_intern and return
+// 0 otherwise. meta_strings_save writes the whole table as one block if size
+// is large enough and returns the size it needs. meta_strings_clear frees
+// the table, invalidating every interned string.
+int meta_strings_init(void* block, unsigned size);
+int meta_strings_attach(const void* block, unsigned size);
+unsigned meta_strings_save(void* block, unsigned size);
+void meta_strings_clear(void);
+const char* meta_intern(const char* str);
+int meta_string_is_interned(const char* str);
+unsigned meta_string_index(const char* interned);
+const char* meta_string_at(unsigned index);
+
+// a delta is a bitmask with one bit per entry in meta->layout, followed by
+// the new values of the changed attributes packed in layout order, with
+// strings written as string table indices (interning strings that were
+// assigned directly); the buffer needs no particular alignment;
+// meta_diff returns the bytes written, or 0 if nothing changed
+unsigned meta_delta_max_size(const meta* meta);
+unsigned meta_diff(const meta* meta, const void* from, const void* to, void* delta);
+void meta_patch(const meta* meta, void* object, const void* delta);
+
 #define META(NAME) ((const meta*)&g_meta__ ## NAME)
 
 #define META_DECLARE(NAME, SUPER) \
@@ -42,7 +42,8 @@ META_END_EVENTS()
 
 void TestBase_event_input(TestBase* base, const char* input)
 {
-	if (base->last_input != NULL && 0 == strcmp(input, base->last_input))
+	input = meta_intern(input);
+	if (input == base->last_input)
 		++base->counter;
 	else
 	{
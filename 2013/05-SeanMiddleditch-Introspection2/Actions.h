@@ -0,0 +1,300 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+#include "Tween.h"
+
+#include <cstdint>
+
+namespace Meta
+{
+	//! \brief Runs timed actions on reflected objects: waits, method calls, member sets and tweens of float members.
+	//! Actions run in the order they were added, and each belongs to one or more of 32 lanes. An unfinished blocking
+	//! action holds back every later action sharing a lane with it, so the actions of a lane form a sequence while
+	//! separate lanes run in parallel. Methods and members are resolved when an action is added. The lane masks are
+	//! stored apart from the actions, so a held back action costs a single test, and the update stops early once every
+	//! lane in use is blocked. Finished actions are compacted away and their storage, including that of arguments,
+	//! is reused. Methods called by actions must not add actions to or cancel actions of the list running them.
+	class ActionList
+	{
+	public:
+		//! \brief A set of lanes, one bit each.
+		typedef uint32_t Lanes;
+
+		static const int MaxArgs = 4; //!< Arguments a Call can store.
+
+	private:
+		//! \brief One action.  Which fields are used depends on the kind.
+		struct Action
+		{
+			enum Kind
+			{
+				Wait, //!< Count down time.
+				Call, //!< Call method with the stored arguments.
+				Set, //!< Set member to the stored value.
+				Tween, //!< Animate target.
+			};
+
+			Kind kind; //!< What the action does.
+			bool blocking; //!< Whether later actions in its lanes wait for it to finish.
+			Tweener::Ease ease; //!< The curve of a Tween.
+			int argc; //!< The number of arguments of a Call.
+			size_t args; //!< Index of the first stored argument of a Call or the value of a Set.
+			float time; //!< Seconds left of a Wait, or the normalized time of a Tween.
+			float rate; //!< The normalized time per second of a Tween.
+			float from; //!< The start value of a Tween.
+			float to; //!< The end value of a Tween.
+			float* target; //!< The animated value of a Tween.
+			char* obj; //!< The object of a Call or Set, already adjusted to the owner of the method or member.
+			const Method* method; //!< The method of a Call.
+			const Member* member; //!< The member of a Set.
+		};
+
+		std::vector<Lanes> m_Lanes; //!< The lanes of each action, kept apart so held back actions are skipped cheaply.
+		std::vector<Action> m_Actions; //!< The actions, in order.
+		std::vector<Any> m_Args; //!< Blocks of MaxArgs stored arguments.
+		std::vector<size_t> m_FreeArgs; //!< Indices of unused argument blocks.
+		Lanes m_Used; //!< Every lane an action was added to since the list was last empty.
+
+		ActionList(const ActionList&); // = delete
+		void operator=(const ActionList&); // = delete
+
+		//! \brief Stores arguments in a free block.
+		//! \returns The index of the first argument.
+		size_t Store(int argc, const Any* argv)
+		{
+			size_t block;
+			if (!m_FreeArgs.empty())
+			{
+				block = m_FreeArgs.back();
+				m_FreeArgs.pop_back();
+			}
+			else
+			{
+				block = m_Args.size();
+				m_Args.resize(block + MaxArgs);
+			}
+			for (int i = 0; i != argc; ++i)
+				m_Args[block + i] = argv[i];
+			return block;
+		}
+
+		//! \brief Releases the argument block of an action.
+		void Release(const Action& a)
+		{
+			if (a.kind != Action::Call && a.kind != Action::Set)
+				return;
+			for (int i = 0; i != MaxArgs; ++i)
+				m_Args[a.args + i] = Any();
+			m_FreeArgs.push_back(a.args);
+		}
+
+		void Push(Lanes lanes, const Action& a)
+		{
+			m_Lanes.push_back(lanes);
+			m_Actions.push_back(a);
+			m_Used |= lanes;
+		}
+
+		static Action Make(Action::Kind kind, bool blocking)
+		{
+			Action a = Action();
+			a.kind = kind;
+			a.blocking = blocking;
+			return a;
+		}
+
+		//! \brief Advances an action.
+		//! \returns True if the action finished.
+		bool Run(Action& a, float dt)
+		{
+			switch (a.kind)
+			{
+			case Action::Wait:
+				a.time -= dt;
+				return a.time <= 0.f;
+			case Action::Call:
+				a.method->Call(Any(static_cast<void*>(a.obj), a.method->GetOwner()), a.argc, &m_Args[a.args]);
+				return true;
+			case Action::Set:
+				a.member->Set(Any(static_cast<void*>(a.obj), a.member->GetOwner()), m_Args[a.args]);
+				return true;
+			case Action::Tween:
+				{
+					const float t = a.time + dt * a.rate < 1.f ? a.time + dt * a.rate : 1.f;
+					a.time = t;
+					*a.target = Tweener::Lerp(a.from, a.to, Tweener::Curve(a.ease, t));
+					return t >= 1.f;
+				}
+			}
+			return true;
+		}
+
+	public:
+		ActionList() : m_Used(0) { }
+
+		//! \brief Retrieves the number of unfinished actions.
+		size_t GetCount() const { return m_Actions.size(); }
+
+		//! \brief Adds an action that holds back the later actions of its lanes for a time.
+		//! \returns False if lanes is empty.
+		bool Wait(Lanes lanes, float seconds)
+		{
+			if (lanes == 0)
+				return false;
+			Action a = Make(Action::Wait, true);
+			a.time = seconds;
+			Push(lanes, a);
+			return true;
+		}
+
+		//! \brief Adds an action that calls a method of an object, discarding any return value.
+		//! \param lanes The lanes of the action.
+		//! \param type The exact type of the object.
+		//! \param obj The object, which must outlive the action or have its lanes cancelled.
+		//! \param name The name of a method of the type or of one of its bases.
+		//! \param argc The number of arguments, at most MaxArgs.
+		//! \param argv The arguments, which are copied.  An Any referring to an object still refers to it when the call is made.
+		//! \returns False if lanes is empty or the method does not exist or cannot be called with the arguments.
+		bool Call(Lanes lanes, const TypeInfo* type, void* obj, const char* name, int argc = 0, const Any* argv = nullptr)
+		{
+			auto e = type->FindMethodEntry(name);
+			if (lanes == 0 || e == nullptr || argc > MaxArgs)
+				return false;
+
+			char* owner = static_cast<char*>(obj) + e->offset;
+			if (!e->item->CanCall(Any(static_cast<void*>(owner), e->item->GetOwner()), argc, argv))
+				return false;
+
+			Action a = Make(Action::Call, false);
+			a.method = e->item;
+			a.obj = owner;
+			a.argc = argc;
+			a.args = Store(argc, argv);
+			Push(lanes, a);
+			return true;
+		}
+
+		//! \brief Adds an action that sets a member of an object.  See Call for the parameters.
+		//! \returns False if lanes is empty or the member does not exist or cannot be set to the value.
+		bool Set(Lanes lanes, const TypeInfo* type, void* obj, const char* name, const Any& value)
+		{
+			auto e = type->FindMemberEntry(name);
+			if (lanes == 0 || e == nullptr)
+				return false;
+
+			char* owner = static_cast<char*>(obj) + e->offset;
+			if (!e->item->CanSet(Any(static_cast<void*>(owner), e->item->GetOwner()), value))
+				return false;
+
+			Action a = Make(Action::Set, false);
+			a.member = e->item;
+			a.obj = owner;
+			a.args = Store(1, &value);
+			Push(lanes, a);
+			return true;
+		}
+
+		//! \brief Adds an action that animates a plain float member of an object, like Tweener::Add.
+		//! \param blocking Whether later actions in its lanes wait for the tween to finish.
+		//! \returns False if lanes is empty or the type has no plain float member with that name.
+		bool Tween(Lanes lanes, const TypeInfo* type, void* obj, const char* name, float from, float to, float duration, Tweener::Ease ease = Tweener::Linear, bool blocking = true)
+		{
+			auto field = type->FindField<float>(name);
+			if (lanes == 0 || !field.IsValid())
+				return false;
+
+			Action a = Make(Action::Tween, blocking);
+			a.ease = ease;
+			a.target = &field.Ref(obj);
+			a.from = from;
+			a.to = to;
+			a.rate = duration > 0.f ? 1.f / duration : 1e30f;
+			Push(lanes, a);
+			return true;
+		}
+
+		//! \brief Adds an action that calls a method of an object of a statically known type.
+		template <typename Type> bool Call(Lanes lanes, Type& obj, const char* name, int argc = 0, const Any* argv = nullptr) { return Call(lanes, Get<Type>(), &obj, name, argc, argv); }
+
+		//! \brief Adds an action that sets a member of an object of a statically known type.
+		template <typename Type> bool Set(Lanes lanes, Type& obj, const char* name, const Any& value) { return Set(lanes, Get<Type>(), &obj, name, value); }
+
+		//! \brief Adds an action that animates a float member of an object of a statically known type.
+		template <typename Type> bool Tween(Lanes lanes, Type& obj, const char* name, float from, float to, float duration, Tweener::Ease ease = Tweener::Linear, bool blocking = true)
+		{
+			return Tween(lanes, Get<Type>(), &obj, name, from, to, duration, ease, blocking);
+		}
+
+		//! \brief Removes every action in any of the given lanes.
+		void Cancel(Lanes lanes)
+		{
+			size_t out = 0;
+			for (size_t i = 0; i != m_Actions.size(); ++i)
+			{
+				if (m_Lanes[i] & lanes)
+				{
+					Release(m_Actions[i]);
+					continue;
+				}
+				m_Lanes[out] = m_Lanes[i];
+				m_Actions[out++] = m_Actions[i];
+			}
+			m_Lanes.resize(out);
+			m_Actions.resize(out);
+			if (out == 0)
+				m_Used = 0;
+		}
+
+		//! \brief Removes all actions.
+		void Clear() { Cancel(~Lanes(0)); }
+
+		//! \brief Advances the actions that are not held back.  Actions that finish release their lanes within the same
+		//! update, so a sequence of instant actions runs in one update.
+		//! \param dt The elapsed time in seconds.
+		void Update(float dt)
+		{
+			const Lanes* const lanes = m_Lanes.data();
+			Action* const actions = m_Actions.data();
+			const size_t count = m_Actions.size();
+			Lanes blocked = 0;
+			size_t finished = count; // the first finished action, from which the list is compacted
+
+			for (size_t i = 0; i != count && (blocked & m_Used) != m_Used; ++i)
+			{
+				if (lanes[i] & blocked)
+					continue;
+
+				Action& a = actions[i];
+				if (Run(a, dt))
+				{
+					Release(a);
+					m_Lanes[i] = 0; // marks the action as finished
+					if (finished == count)
+						finished = i;
+				}
+				else if (a.blocking)
+					blocked |= lanes[i];
+			}
+
+			if (finished == count)
+				return;
+
+			size_t out = finished;
+			for (size_t i = finished; i != count; ++i)
+			{
+				if (lanes[i] == 0)
+					continue;
+				m_Lanes[out] = lanes[i];
+				actions[out++] = actions[i];
+			}
+			m_Lanes.resize(out);
+			m_Actions.resize(out);
+			if (out == 0)
+				m_Used = 0;
+		}
+	};
+}
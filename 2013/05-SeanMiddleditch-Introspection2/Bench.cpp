@@ -0,0 +1,223 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+unsigned long long Bench::g_Allocations = 0;
+volatile int Bench::g_Sink = 0;
+unsigned Bench::g_Iterations = 1000000;
+
+// count every heap allocation so cases can report allocations per operation
+void* operator new(std::size_t size)
+{
+	++Bench::g_Allocations;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) throw()
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) throw()
+{
+	std::free(p);
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete[](void* p) throw() { operator delete(p); }
+void operator delete[](void* p, std::size_t) throw() { operator delete(p); }
+
+namespace
+{
+	// every case in report order; an API that does not run a case reports n/a for it
+	const char* const s_Cases[] =
+	{
+		"find type",
+		"find member",
+		"find inherited member",
+		"find missing member",
+		"find member static",
+		"find inherited static",
+		"get float",
+		"set float",
+		"get inherited int",
+		"set inherited int",
+		"get float field",
+		"set float field",
+		"get inherited int field",
+		"set string",
+		"call 1 arg",
+		"invoke 1 arg typed",
+		"invoke 1 arg static",
+		"call by name",
+		"call 2 args marshaled",
+		"invoke 2 args typed",
+		"vector<Any> push x16",
+		"call large value",
+		"copy large Any",
+		"save object",
+		"load object",
+		"hash object",
+		"equals object",
+		"check inherited",
+		"sum 1024 x",
+		"script call x1000",
+		"call each x1024",
+		"batch call x1024",
+		"ecs iterate 1M",
+		"ecs add+remove",
+		"tween 100k",
+		"tween 100k Set",
+		"actions 100k active",
+		"actions 100k blocked",
+		"migrate 1M",
+		"db open",
+		"db find type",
+		"db find inherited member",
+	};
+
+	const size_t CaseCount = sizeof(s_Cases) / sizeof(s_Cases[0]);
+
+	struct Result
+	{
+		const char* api;
+		size_t index;
+		double ns;
+		double allocs;
+	};
+
+	std::vector<const char*> s_Apis; //!< APIs in the order they first recorded a case.
+	std::vector<Result> s_Results; //!< Every recorded result.
+
+	size_t FindCase(const char* name)
+	{
+		for (size_t i = 0; i != CaseCount; ++i)
+			if (std::strcmp(s_Cases[i], name) == 0)
+				return i;
+		return CaseCount;
+	}
+}
+
+void Bench::Record(const char* api, const char* name, double ns, double allocs)
+{
+	const size_t index = FindCase(name);
+	assert(index != CaseCount && "case is missing from s_Cases");
+	if (s_Apis.empty() || std::strcmp(s_Apis.back(), api) != 0)
+		s_Apis.push_back(api);
+
+	Result r = { api, index, ns, allocs };
+	s_Results.push_back(r);
+}
+
+void Bench::Report()
+{
+	std::printf("%-8s %-24s %12s %12s\n", "api", "case", "ns/op", "allocs/op");
+	for (auto api : s_Apis)
+	{
+		for (size_t i = 0; i != CaseCount; ++i)
+		{
+			auto r = std::find_if(s_Results.begin(), s_Results.end(), [&](const Result& r) { return std::strcmp(r.api, api) == 0 && r.index == i; });
+			if (r != s_Results.end())
+				std::printf("%-8s %-24s %12.2f %12.2f\n", api, s_Cases[i], r->ns, r->allocs);
+			else
+				std::printf("%-8s %-24s %12s %12s\n", api, s_Cases[i], "n/a", "n/a");
+		}
+	}
+}
+
+namespace
+{
+	// the shape shared by all three APIs: a base with a string and a counter,
+	// and a derived type adding two floats and an event/method
+	struct Base
+	{
+		const char* last_input;
+		int counter;
+	};
+
+	struct Matrix
+	{
+		float m[16];
+	};
+
+	struct Vector
+	{
+		float x, y, z;
+	};
+
+	// the components of an entity, stored together
+	struct Body
+	{
+		Vector position;
+		Vector velocity;
+	};
+
+	struct Derived : Base
+	{
+		float x, y;
+
+		void jumped(float height) { x += height; }
+		float scale(double factor, char bias) { return (float)(x * factor) + bias; }
+		Matrix transform(const Matrix& m) { Matrix r = m; r.m[0] += x; return r; }
+	};
+}
+
+void Bench::RunDirect()
+{
+	Derived obj = Derived();
+	// reach the object through a volatile pointer so the loops are not collapsed
+	Derived* volatile d = &obj;
+	const char* inputs[2] = { "jump", "fire" };
+
+	Run("direct", "get float", [&](unsigned) { g_Sink += (int)d->x; });
+	Run("direct", "set float", [&](unsigned i) { d->x = (float)i; });
+	Run("direct", "get inherited int", [&](unsigned) { g_Sink += d->counter; });
+	Run("direct", "set inherited int", [&](unsigned i) { d->counter = (int)i; });
+	Run("direct", "set string", [&](unsigned i) { d->last_input = inputs[i & 1]; });
+	Run("direct", "call 1 arg", [&](unsigned) { d->jumped(1.f); });
+	Run("direct", "call 2 args marshaled", [&](unsigned i) { g_Sink += (int)d->scale((double)i, (char)7); });
+	Matrix matrix = Matrix();
+	Run("direct", "call large value", [&](unsigned) { g_Sink += (int)d->transform(matrix).m[0]; });
+	std::vector<Derived> many(1024, obj);
+	Run("direct", "sum 1024 x", [&](unsigned) { float sum = 0.f; for (auto& m : many) sum += m.x; g_Sink += (int)sum; });
+	std::vector<Body> bodies(1 << 20);
+	Run("direct", "ecs iterate 1M", [&](unsigned) { for (auto& b : bodies) { b.position.x += b.velocity.x; b.position.y += b.velocity.y; b.position.z += b.velocity.z; } }, 1 << 17);
+	std::vector<Derived> selected(1024, obj);
+	Run("direct", "call each x1024", [&](unsigned) { for (auto& s : selected) s.jumped(1.f); }, 1024);
+	struct Tween { float* target; float from, delta, time, rate; };
+	std::vector<Derived> animated(100000, obj);
+	std::vector<Tween> tweens;
+	for (auto& a : animated)
+		tweens.push_back(Tween{ &a.x, 0.f, 1.f, 0.f, 1e-6f });
+	Run("direct", "tween 100k", [&](unsigned) { for (auto& t : tweens) { t.time = t.time + 0.001f * t.rate < 1.f ? t.time + 0.001f * t.rate : 1.f; *t.target = t.from + t.delta * t.time * t.time * (3.f - 2.f * t.time); } }, 1 << 14);
+	struct Reloaded : Base { double x; float y, z; };
+	std::vector<Derived> live(1 << 20, obj);
+	std::vector<Reloaded> reloaded(live.size());
+	Run("direct", "migrate 1M", [&](unsigned) { for (size_t n = 0; n != live.size(); ++n) { Reloaded* r = new (&reloaded[n]) Reloaded(); r->counter = live[n].counter; r->x = live[n].x; r->y = live[n].y; } }, 1 << 20);
+	g_Sink += (int)obj.x;
+}
+
+// usage: MetaBench [iterations]
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+		Bench::g_Iterations = (unsigned)std::strtoul(argv[1], nullptr, 10);
+	if (Bench::g_Iterations == 0)
+		Bench::g_Iterations = 1;
+
+	Bench::RunDirect();
+	Bench::RunC();
+	Bench::RunMeta();
+	Bench::Report();
+}
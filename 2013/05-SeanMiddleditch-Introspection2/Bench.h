@@ -0,0 +1,60 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+//! Namespace containing the introspection benchmark harness.
+namespace Bench
+{
+	//! \brief Number of heap allocations made through operator new so far.
+	extern unsigned long long g_Allocations;
+
+	//! \brief Sink that results are written to so the optimizer cannot discard the measured work.
+	extern volatile int g_Sink;
+
+	//! \brief Base iteration count, scaled per case by the cost of the operation.
+	extern unsigned g_Iterations;
+
+	//! \brief Record the result of a case, which must be listed in Bench.cpp.
+	void Record(const char* api, const char* name, double ns, double allocs);
+
+	//! \brief Print the result table: every case for every API, with n/a where an API did not run a case.
+	void Report();
+
+	//! \brief Time a case and record its result.
+	//! \param api The API being measured (direct, C, C++).
+	//! \param name The name of the case.
+	//! \param fn The operation; called once per iteration with the iteration index.
+	//! \param scale The cost of the operation relative to a simple one; the base iteration count is divided by it.
+	template <typename Function> void Run(const char* api, const char* name, Function fn, unsigned scale = 1)
+	{
+		const unsigned count = g_Iterations / scale != 0 ? g_Iterations / scale : 1;
+
+		// warm up caches and any lazily built state
+		for (unsigned i = 0; i != count / 10 + 1; ++i)
+			fn(i);
+
+		unsigned long long allocs = g_Allocations;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (unsigned i = 0; i != count; ++i)
+			fn(i);
+		auto end = std::chrono::high_resolution_clock::now();
+		allocs = g_Allocations - allocs;
+
+		double ns = std::chrono::duration<double, std::nano>(end - start).count();
+		Record(api, name, ns / count, double(allocs) / count);
+	}
+
+	//! \brief Benchmarks plain field access and calls, the baseline for the other APIs.
+	void RunDirect();
+
+	//! \brief Benchmarks the C meta library from the first introspection talk.
+	void RunC();
+
+	//! \brief Benchmarks the C++ Meta library.
+	void RunMeta();
+}
@@ -0,0 +1,82 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#include "../03-SeanMiddleditch-Introspection1/meta.h"
+#include "Bench.h"
+
+#include <vector>
+
+struct BenchBase
+{
+	const char* last_input;
+	int counter;
+};
+
+struct BenchDerived
+{
+	struct BenchBase _base;
+
+	float x;
+	float y;
+};
+
+static void BenchDerived_event_jumped(BenchDerived* d, const float* height)
+{
+	d->x += *height;
+}
+
+META_BASE_DECLARE(BenchBase)
+META_DECLARE(BenchDerived, BenchBase)
+
+META_DEFINE(BenchBase)
+META_DEFINE(BenchDerived)
+
+META_BEGIN_ATTRS(BenchBase)
+	META_ATTR(last_input, MT_STRING)
+	META_ATTR(counter, MT_SINT32)
+META_END_ATTRS()
+
+META_BEGIN_EVENTS(BenchBase)
+META_END_EVENTS()
+
+META_BEGIN_ATTRS(BenchDerived)
+	META_ATTR(x, MT_FLOAT)
+	META_ATTR(y, MT_FLOAT)
+META_END_ATTRS()
+
+META_BEGIN_EVENTS(BenchDerived)
+	META_EVENT(jumped, BenchDerived_event_jumped)
+META_END_EVENTS()
+
+void Bench::RunC()
+{
+	META_INIT(BenchBase);
+	META_INIT(BenchDerived);
+
+	BenchDerived d;
+	memset(&d, 0, sizeof(d));
+
+	const meta* type = meta_find("BenchDerived");
+	const meta_attribute* x = meta_find_attribute(type, "x");
+	const meta_attribute* counter = meta_find_attribute(type, "counter");
+	const meta_attribute* last_input = meta_find_attribute(type, "last_input");
+	const meta_event* jumped = meta_find_event(type, "jumped");
+	const char* inputs[2] = { "jump", "fire" };
+
+	Run("C", "find type", [&](unsigned) { g_Sink += meta_find("BenchDerived") != 0; });
+	Run("C", "find member", [&](unsigned) { g_Sink += meta_find_attribute(type, "x") != 0; });
+	Run("C", "find inherited member", [&](unsigned) { g_Sink += meta_find_attribute(type, "counter") != 0; });
+	Run("C", "find missing member", [&](unsigned) { g_Sink += meta_find_attribute(type, "missing") != 0; });
+	Run("C", "get float", [&](unsigned) { float f; meta_get(x, &d, &f); g_Sink += (int)f; });
+	Run("C", "set float", [&](unsigned i) { float f = (float)i; meta_set(x, &d, &f); });
+	Run("C", "get inherited int", [&](unsigned) { int v; meta_get(counter, &d, &v); g_Sink += v; });
+	Run("C", "set inherited int", [&](unsigned i) { int v = (int)i; meta_set(counter, &d, &v); });
+	Run("C", "set string", [&](unsigned i) { meta_set(last_input, &d, &inputs[i & 1]); });
+	Run("C", "call 1 arg", [&](unsigned) { float height = 1.f; meta_call(jumped, &d, &height); });
+	std::vector<BenchDerived> selected(1024, d);
+	Run("C", "call each x1024", [&](unsigned) { for (auto& s : selected) { float height = 1.f; if (auto e = meta_find_event(type, "jumped")) meta_call(e, &s, &height); } }, 1024);
+	std::vector<BenchDerived> animated(100000, d);
+	Run("C", "tween 100k Set", [&](unsigned i) { const float t = (float)i * 1e-9f; for (auto& a : animated) { float v = t * t * (3.f - 2.f * t); meta_set(x, &a, &v); } }, 1 << 14);
+	g_Sink += (int)d.x;
+}
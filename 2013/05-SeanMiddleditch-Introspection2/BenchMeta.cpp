@@ -0,0 +1,225 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#include "Meta.h"
+#include "Actions.h"
+#include "Components.h"
+#include "Database.h"
+#include "Hash.h"
+#include "Migrate.h"
+#include "Script.h"
+#include "Serialize.h"
+#include "Soa.h"
+#include "Tween.h"
+#include "Bench.h"
+
+struct BenchBase
+{
+	const char* last_input;
+	int counter;
+};
+
+// a value too large for the inline storage of an Any
+struct BenchMatrix
+{
+	float m[16];
+};
+
+struct BenchPosition
+{
+	float x, y, z;
+};
+
+struct BenchVelocity
+{
+	float x, y, z;
+};
+
+struct BenchDerived : BenchBase
+{
+	float x, y;
+
+	void jumped(float height) { x += height; }
+	float scale(double factor, char bias) { return (float)(x * factor) + bias; }
+	BenchMatrix transform(const BenchMatrix& m) { BenchMatrix r = m; r.m[0] += x; return r; }
+};
+
+// holds a reflected string, for setting one through a Member
+struct BenchNamed
+{
+	std::string name;
+};
+
+// BenchDerived as recompiled by a plugin: x widened to double and z added
+struct BenchReloaded : BenchBase
+{
+	double x;
+	float y, z;
+};
+
+META_DEFINE_EXTERN(std::string);
+META_DEFINE_EXTERN(BenchMatrix);
+
+META_DEFINE_EXTERN(BenchPosition);
+META_DEFINE_EXTERN(BenchVelocity);
+
+META_DEFINE_EXTERN(BenchBase)
+	.member("counter", &BenchBase::counter);
+
+META_DEFINE_EXTERN(BenchDerived)
+	.base<BenchBase>()
+	.member("x", &BenchDerived::x)
+	.member("y", &BenchDerived::y)
+	.method("jumped", &BenchDerived::jumped)
+	.method("scale", &BenchDerived::scale)
+	.method("transform", &BenchDerived::transform);
+
+META_DEFINE_EXTERN(BenchNamed)
+	.member("name", &BenchNamed::name);
+
+META_DEFINE_EXTERN(BenchReloaded)
+	.base<BenchBase>()
+	.member("x", &BenchReloaded::x)
+	.member("y", &BenchReloaded::y)
+	.member("z", &BenchReloaded::z);
+
+static constexpr Meta::StaticField s_BenchBaseFields[] = { META_STATIC_FIELD(BenchBase, counter) };
+META_DEFINE_STATIC(BenchBase, {}, s_BenchBaseFields, {});
+
+static constexpr Meta::StaticBase s_BenchDerivedBases[] = { META_STATIC_BASE(BenchDerived, BenchBase) };
+static constexpr Meta::StaticField s_BenchDerivedFields[] = { META_STATIC_FIELD(BenchDerived, x), META_STATIC_FIELD(BenchDerived, y) };
+static constexpr Meta::StaticMethod s_BenchDerivedMethods[] = { META_STATIC_METHOD(BenchDerived, jumped), META_STATIC_METHOD(BenchDerived, scale) };
+META_DEFINE_STATIC(BenchDerived, s_BenchDerivedBases, s_BenchDerivedFields, s_BenchDerivedMethods);
+
+void Bench::RunMeta()
+{
+	BenchDerived d = BenchDerived();
+
+	const Meta::TypeInfo* type = Meta::Get<BenchDerived>();
+	const Meta::Member* x = type->FindMember("x");
+	const Meta::Member* counter = type->FindMember("counter");
+	const Meta::Method* jumped = type->FindMethod("jumped");
+	const Meta::Method* scale = type->FindMethod("scale");
+	const Meta::Method* transform = type->FindMethod("transform");
+	Meta::TypedField<float> xField = type->FindField<float>("x");
+	Meta::TypedField<int> counterField = type->FindField<int>("counter");
+	const Meta::StaticTypeInfo* staticType = Meta::GetStatic<BenchDerived>();
+	ptrdiff_t offset;
+	const Meta::StaticMethod* staticJumped = staticType->FindMethod("jumped", offset);
+	Meta::Any argv[1] = { 1.f };
+	Meta::Any matrix[1] = { BenchMatrix() };
+	BenchNamed named;
+	const Meta::Member* name = Meta::Get<BenchNamed>()->FindMember("name");
+	Meta::Any inputs[2] = { std::string("jump"), std::string("fire") };
+
+	Run("C++", "find type", [&](unsigned) { g_Sink += Meta::Registry::Instance().Find("BenchDerived") != nullptr; });
+	Run("C++", "find member", [&](unsigned) { g_Sink += type->FindMember("x") != nullptr; });
+	Run("C++", "find inherited member", [&](unsigned) { g_Sink += type->FindMember("counter") != nullptr; });
+	Run("C++", "find missing member", [&](unsigned) { g_Sink += type->FindMember("missing") != nullptr; });
+	Run("C++", "find member static", [&](unsigned) { g_Sink += staticType->FindField("x", offset) != nullptr; });
+	Run("C++", "find inherited static", [&](unsigned) { g_Sink += staticType->FindField("counter", offset) != nullptr; });
+	Run("C++", "get float", [&](unsigned) { g_Sink += (int)x->Get(&d).GetReference<float>(); });
+	Run("C++", "set float", [&](unsigned i) { x->Set(&d, Meta::Any((float)i)); });
+	Run("C++", "get inherited int", [&](unsigned) { g_Sink += counter->Get(&d).GetReference<int>(); });
+	Run("C++", "set inherited int", [&](unsigned i) { counter->Set(&d, Meta::Any((int)i)); });
+	Run("C++", "get float field", [&](unsigned) { g_Sink += (int)xField.Get(&d); });
+	Run("C++", "set float field", [&](unsigned i) { xField.Set(&d, (float)i); g_Sink += (int)xField.Get(&d); });
+	Run("C++", "get inherited int field", [&](unsigned) { g_Sink += counterField.Get(&d); });
+	Run("C++", "set string", [&](unsigned i) { name->Set(&named, inputs[i & 1]); });
+	Run("C++", "call 1 arg", [&](unsigned) { jumped->Call(&d, 1, argv); });
+	Run("C++", "invoke 1 arg typed", [&](unsigned) { jumped->Invoke<void, float>(&d, 1.f); });
+	Run("C++", "invoke 1 arg static", [&](unsigned) { staticJumped->Invoke<void, float>(&d, 1.f); });
+	Run("C++", "call by name", [&](unsigned) { auto m = Meta::Get<BenchDerived>()->FindMethod("jumped"); if (m->CanCall(&d, 1, argv)) m->Call(&d, 1, argv); });
+	Run("C++", "call 2 args marshaled", [&](unsigned i) { Meta::Any args[2] = { (double)i, (char)7 }; g_Sink += (int)scale->Call(&d, 2, args).GetReference<float>(); });
+	Run("C++", "invoke 2 args typed", [&](unsigned i) { g_Sink += (int)scale->Invoke<float, double, char>(&d, (double)i, (char)7); });
+	Run("C++", "vector<Any> push x16", [&](unsigned i) { std::vector<Meta::Any> v; for (int n = 0; n != 16; ++n) v.push_back(Meta::Any((int)i)); g_Sink += (int)v.size(); });
+	Run("C++", "call large value", [&](unsigned) { g_Sink += (int)transform->Call(&d, 1, matrix).GetReference<BenchMatrix>().m[0]; });
+	Run("C++", "copy large Any", [&](unsigned) { Meta::Any copy(matrix[0]); g_Sink += copy.GetType() != nullptr; });
+	Meta::BufferWriter writer;
+	Meta::Serializer::Instance().Save(writer, d);
+	const std::vector<char> saved = writer.GetBuffer();
+	Run("C++", "save object", [&](unsigned) { writer.Clear(); Meta::Serializer::Instance().Save(writer, d); g_Sink += (int)writer.GetBuffer().size(); });
+	Run("C++", "load object", [&](unsigned) { Meta::BufferReader reader(saved.data(), saved.size()); g_Sink += Meta::Serializer::Instance().Load(reader, d); });
+	BenchDerived other = d;
+	Run("C++", "hash object", [&](unsigned) { g_Sink += (int)Meta::Hasher::Instance().Hash(d); });
+	Run("C++", "equals object", [&](unsigned) { g_Sink += Meta::Hasher::Instance().Equals(d, other); });
+	Run("C++", "check inherited", [&](unsigned) { g_Sink += counter->CanSet(&d, argv[0]); });
+	Meta::SoaArray many(type);
+	for (int n = 0; n != 1024; ++n)
+		many.Push(&d);
+	Meta::Span<float> manyX = many.GetColumn<float>("x");
+	Run("C++", "sum 1024 x", [&](unsigned) { float sum = 0.f; for (float x : manyX) sum += x; g_Sink += (int)sum; });
+
+	// calls jumped(1) a thousand times: r0 = object, r1 = counter, r2 = limit, r3 = step, r4 = condition, r5 = argument
+	typedef Meta::Instruction I;
+	Meta::Script script;
+	const int site = script.AddSite("jumped", 1);
+	script.Emit(I::Load, 1, script.AddConstant(0));
+	script.Emit(I::Load, 2, script.AddConstant(1000));
+	script.Emit(I::Load, 3, script.AddConstant(1));
+	script.Emit(I::Load, 5, script.AddConstant(1.f));
+	const int loop = script.Emit(I::Less, 4, 1, 2);
+	const int exit = script.Emit(I::JumpIfZero, 4);
+	script.Emit(I::Call, 6, 0, site, 5);
+	script.Emit(I::Add, 1, 1, 3);
+	script.Emit(I::Jump, loop);
+	script.Patch(exit, script.GetNext());
+	Meta::Interpreter interpreter;
+	Meta::Any receiver[1] = { &d };
+	Meta::Any result;
+	Run("C++", "script call x1000", [&](unsigned) { g_Sink += interpreter.Run(script, 1, receiver, result); }, 1000);
+
+	std::vector<BenchDerived> selected(1024, d);
+	Run("C++", "call each x1024", [&](unsigned) { for (auto& s : selected) { auto m = Meta::Get<BenchDerived>()->FindMethod("jumped"); if (m->CanCall(&s, 1, argv)) m->Call(&s, 1, argv); } }, 1024);
+	Run("C++", "batch call x1024", [&](unsigned) { g_Sink += Meta::Get<BenchDerived>()->FindMethod("jumped")->CallBatch(selected.data(), selected.size(), 1, argv); }, 1024);
+
+	Meta::ComponentStore store;
+	for (int n = 0; n != 1 << 20; ++n)
+	{
+		Meta::Entity e = store.Create();
+		store.Add(e, BenchPosition());
+		store.Add(e, BenchVelocity());
+	}
+	Run("C++", "ecs iterate 1M", [&](unsigned) { store.Each<BenchPosition, BenchVelocity>([](BenchPosition& p, BenchVelocity& v) { p.x += v.x; p.y += v.y; p.z += v.z; }); }, 1 << 17);
+	Meta::Entity moving = store.Create();
+	store.Add(moving, BenchPosition());
+	Run("C++", "ecs add+remove", [&](unsigned) { store.Add(moving, BenchVelocity()); store.Remove<BenchVelocity>(moving); });
+
+	// tweens that never finish, so every update does the same work
+	std::vector<BenchDerived> animated(100000, d);
+	Meta::Tweener tweener;
+	for (auto& a : animated)
+		tweener.Add(a, "x", 0.f, 1.f, 1e6f, Meta::Tweener::SmoothStep);
+	Run("C++", "tween 100k", [&](unsigned) { tweener.Update(0.001f); }, 1 << 14);
+	Run("C++", "tween 100k Set", [&](unsigned i) { const float t = (float)i * 1e-9f; for (auto& a : animated) x->Set(&a, Meta::Any(t * t * (3.f - 2.f * t))); }, 1 << 14);
+
+	// every action runs on every update, in parallel lanes
+	Meta::ActionList active;
+	for (size_t n = 0; n != animated.size(); ++n)
+		active.Tween(1u << (n % 32), animated[n], "y", 0.f, 1.f, 1e6f, Meta::Tweener::SmoothStep, false);
+	Run("C++", "actions 100k active", [&](unsigned) { active.Update(0.001f); }, 1 << 14);
+
+	// every action but the last is held back behind a long wait in its lane
+	Meta::ActionList blocked;
+	for (unsigned lane = 0; lane != 31; ++lane)
+		blocked.Wait(1u << lane, 1e6f);
+	for (size_t n = 0; n + 1 != animated.size(); ++n)
+		blocked.Call(1u << (n % 31), animated[n], "jumped", 1, argv);
+	blocked.Tween(1u << 31, animated.back(), "y", 0.f, 1.f, 1e6f);
+	Run("C++", "actions 100k blocked", [&](unsigned) { blocked.Update(0.001f); }, 1 << 10);
+
+	std::vector<BenchDerived> live(1 << 20, d);
+	std::vector<BenchReloaded> reloaded(live.size());
+	Run("C++", "migrate 1M", [&](unsigned) { g_Sink += Meta::Migrator::Instance().Migrate(type, Meta::Get<BenchReloaded>(), live.data(), sizeof(BenchDerived), reloaded.data(), sizeof(BenchReloaded), live.size()); }, 1 << 20);
+
+	Meta::BufferWriter exported;
+	Meta::Database::Export(exported);
+	Meta::Database db;
+	db.Open(exported.GetBuffer().data(), exported.GetBuffer().size());
+	auto entry = db.FindType("BenchDerived");
+	Run("C++", "db open", [&](unsigned) { g_Sink += db.Open(exported.GetBuffer().data(), exported.GetBuffer().size()); });
+	Run("C++", "db find type", [&](unsigned) { g_Sink += db.FindType("BenchDerived") != nullptr; });
+	Run("C++", "db find inherited member", [&](unsigned) { g_Sink += db.FindMember(*entry, "counter") != nullptr; });
+	g_Sink += (int)d.x;
+}
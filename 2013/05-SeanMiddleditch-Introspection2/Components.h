@@ -0,0 +1,302 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+#include "Soa.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <tuple>
+
+namespace Meta
+{
+	//! \brief Identifies an entity in a ComponentStore.  Handles to destroyed entities are detected by their generation.
+	struct Entity
+	{
+		unsigned index; //!< Slot of the entity in the store
+		unsigned generation; //!< Incremented each time the slot is reused
+
+		bool operator==(const Entity& rhs) const { return index == rhs.index && generation == rhs.generation; }
+		bool operator!=(const Entity& rhs) const { return !(*this == rhs); }
+	};
+
+	//! \brief Stores components of reflected types for entities, grouped into archetypes.
+	//! All entities with exactly the same set of component types share an archetype, which keeps one dense Column per
+	//! component type, so queries walk matching archetypes linearly. Adding or removing a component moves the entity's
+	//! components to another archetype with the TypeInfo relocate thunks, or as bytes for trivially copyable types.
+	class ComponentStore
+	{
+	public:
+		//! \brief The entities that have one particular set of component types.
+		class Archetype
+		{
+			std::vector<const TypeInfo*> m_Types; //!< Component types, sorted by address.
+			std::vector<Column> m_Columns; //!< One column per component type, in the same order.
+			std::vector<Entity> m_Entities; //!< The entity of each row.
+			std::vector<std::pair<const TypeInfo*, Archetype*>> m_AddEdges; //!< Cached archetypes reached by adding a type.
+			std::vector<std::pair<const TypeInfo*, Archetype*>> m_RemoveEdges; //!< Cached archetypes reached by removing a type.
+
+			Archetype(const Archetype&); // = delete
+			void operator=(const Archetype&); // = delete
+
+			friend class ComponentStore;
+
+		public:
+			explicit Archetype(const std::vector<const TypeInfo*>& types) : m_Types(types)
+			{
+				m_Columns.reserve(types.size());
+				for (auto t : types)
+					m_Columns.push_back(Column(t));
+			}
+
+			//! \brief Retrieves the component types, sorted by address.
+			const std::vector<const TypeInfo*>& GetTypes() const { return m_Types; }
+
+			//! \brief Retrieves the entity of each row.
+			const std::vector<Entity>& GetEntities() const { return m_Entities; }
+
+			//! \brief Finds the column index of a component type.
+			//! \returns The index or -1 if the archetype does not have the type.
+			int FindColumn(const TypeInfo* type) const
+			{
+				auto i = std::lower_bound(m_Types.begin(), m_Types.end(), type);
+				return i != m_Types.end() && *i == type ? static_cast<int>(i - m_Types.begin()) : -1;
+			}
+
+			//! \brief Retrieves the column of a component type.
+			//! \returns The column or nullptr if the archetype does not have the type.
+			const Column* GetColumn(const TypeInfo* type) const
+			{
+				const int i = FindColumn(type);
+				return i >= 0 ? &m_Columns[i] : nullptr;
+			}
+		};
+
+	private:
+		//! \brief Where an entity's components live.
+		struct Record
+		{
+			Archetype* archetype; //!< The archetype of a live entity, or nullptr for a free slot
+			size_t row; //!< The row within the archetype
+			unsigned generation; //!< The generation of the current or next entity in this slot
+		};
+
+		std::vector<Record> m_Records; //!< Entity slots.
+		std::vector<unsigned> m_FreeSlots; //!< Free entity slots.
+		std::map<std::vector<const TypeInfo*>, std::unique_ptr<Archetype>> m_Archetypes; //!< Archetypes by component types.
+		Archetype* m_Empty; //!< The archetype of entities with no components.
+
+		ComponentStore(const ComponentStore&); // = delete
+		void operator=(const ComponentStore&); // = delete
+
+		//! \brief Finds or creates the archetype for a set of component types.
+		Archetype* GetArchetype(const std::vector<const TypeInfo*>& types)
+		{
+			auto& a = m_Archetypes[types];
+			if (a == nullptr)
+				a.reset(new Archetype(types));
+			return a.get();
+		}
+
+		//! \brief Finds the archetype reached by adding or removing a type, through the cached edges.
+		Archetype* GetNeighbor(Archetype* from, const TypeInfo* type, bool add)
+		{
+			auto& edges = add ? from->m_AddEdges : from->m_RemoveEdges;
+			for (auto& e : edges)
+				if (e.first == type)
+					return e.second;
+
+			std::vector<const TypeInfo*> types = from->m_Types;
+			if (add)
+				types.insert(std::lower_bound(types.begin(), types.end(), type), type);
+			else
+				types.erase(std::lower_bound(types.begin(), types.end(), type));
+
+			Archetype* to = GetArchetype(types);
+			edges.push_back(std::make_pair(type, to));
+			return to;
+		}
+
+		//! \brief Moves an entity's row to another archetype, relocating the components both have and destructing the rest.
+		//! \returns The new row; components only the destination has are left uninitialized.
+		size_t Move(Record& r, Archetype* to)
+		{
+			Archetype* from = r.archetype;
+			const size_t row = r.row;
+			const size_t last = from->m_Entities.size() - 1;
+
+			for (size_t i = 0; i != from->m_Columns.size(); ++i)
+			{
+				Column& src = from->m_Columns[i];
+				const int j = to->FindColumn(from->m_Types[i]);
+				if (j >= 0)
+				{
+					to->m_Columns[j].PushRelocated(src.At(row));
+					src.SwapRemoveRelocated(row);
+				}
+				else
+				{
+					src.SwapRemove(row);
+				}
+			}
+
+			const Entity entity = from->m_Entities[row];
+			if (row != last)
+			{
+				from->m_Entities[row] = from->m_Entities[last];
+				m_Records[from->m_Entities[row].index].row = row;
+			}
+			from->m_Entities.pop_back();
+
+			to->m_Entities.push_back(entity);
+			r.archetype = to;
+			r.row = to->m_Entities.size() - 1;
+			return r.row;
+		}
+
+		//! \brief Retrieves the record of a live entity.
+		Record* GetRecord(Entity entity)
+		{
+			if (entity.index >= m_Records.size())
+				return nullptr;
+			Record& r = m_Records[entity.index];
+			return r.archetype != nullptr && r.generation == entity.generation ? &r : nullptr;
+		}
+
+		template <typename... Components, typename Function, size_t... Indices> static void EachRow(Archetype& a, const int* columns, Function& fn, std::index_sequence<Indices...>)
+		{
+			std::tuple<Components*...> data(static_cast<Components*>(a.m_Columns[columns[Indices]].GetData())...);
+			const size_t count = a.m_Entities.size();
+			for (size_t row = 0; row != count; ++row)
+				fn(std::get<Indices>(data)[row]...);
+		}
+
+	public:
+		ComponentStore() : m_Empty(GetArchetype(std::vector<const TypeInfo*>())) { }
+
+		//! \brief Creates an entity with no components.
+		Entity Create()
+		{
+			unsigned index;
+			if (!m_FreeSlots.empty())
+			{
+				index = m_FreeSlots.back();
+				m_FreeSlots.pop_back();
+			}
+			else
+			{
+				index = static_cast<unsigned>(m_Records.size());
+				Record r = { nullptr, 0, 0 };
+				m_Records.push_back(r);
+			}
+
+			Record& r = m_Records[index];
+			const Entity entity = { index, r.generation };
+			r.archetype = m_Empty;
+			r.row = m_Empty->m_Entities.size();
+			m_Empty->m_Entities.push_back(entity);
+			return entity;
+		}
+
+		//! \brief Destroys an entity and its components.
+		void Destroy(Entity entity)
+		{
+			Record* r = GetRecord(entity);
+			if (r == nullptr)
+				return;
+
+			Move(*r, m_Empty);
+			m_Empty->m_Entities.pop_back();
+			r->archetype = nullptr;
+			++r->generation;
+			m_FreeSlots.push_back(entity.index);
+		}
+
+		//! \brief Checks if an entity has not been destroyed.
+		bool IsAlive(Entity entity) { return GetRecord(entity) != nullptr; }
+
+		//! \brief Adds a default constructed component to an entity, or finds the existing one.
+		//! \returns The component, or nullptr if the entity is not alive.
+		void* Add(Entity entity, const TypeInfo* type)
+		{
+			Record* r = GetRecord(entity);
+			if (r == nullptr)
+				return nullptr;
+
+			const int existing = r->archetype->FindColumn(type);
+			if (existing >= 0)
+				return r->archetype->m_Columns[existing].At(r->row);
+
+			Archetype* to = GetNeighbor(r->archetype, type, true);
+			Move(*r, to);
+			return to->m_Columns[to->FindColumn(type)].Push();
+		}
+
+		//! \brief Adds a component to an entity, or replaces the existing one.
+		//! \returns The component, or nullptr if the entity is not alive.
+		template <typename Type> Type* Add(Entity entity, const Type& value)
+		{
+			Type* component = static_cast<Type*>(Add(entity, Get<Type>()));
+			if (component != nullptr)
+				*component = value;
+			return component;
+		}
+
+		//! \brief Removes a component from an entity.
+		void Remove(Entity entity, const TypeInfo* type)
+		{
+			Record* r = GetRecord(entity);
+			if (r == nullptr || r->archetype->FindColumn(type) < 0)
+				return;
+			Move(*r, GetNeighbor(r->archetype, type, false));
+		}
+
+		//! \brief Removes a component from an entity.
+		template <typename Type> void Remove(Entity entity) { Remove(entity, Get<Type>()); }
+
+		//! \brief Finds a component of an entity.
+		//! \returns The component, or nullptr if the entity is not alive or does not have the component.
+		void* Find(Entity entity, const TypeInfo* type)
+		{
+			Record* r = GetRecord(entity);
+			if (r == nullptr)
+				return nullptr;
+			const int i = r->archetype->FindColumn(type);
+			return i >= 0 ? r->archetype->m_Columns[i].At(r->row) : nullptr;
+		}
+
+		//! \brief Finds a component of an entity.
+		template <typename Type> Type* Find(Entity entity) { return static_cast<Type*>(Find(entity, Get<Type>())); }
+
+		//! \brief Retrieves the archetypes, including empty ones.
+		template <typename Function> void EachArchetype(Function fn) const
+		{
+			for (auto& a : m_Archetypes)
+				fn(*a.second);
+		}
+
+		//! \brief Calls a function with references to the given components of every entity that has all of them.
+		//! Components must not be added or removed during the call.
+		template <typename... Components, typename Function> void Each(Function fn)
+		{
+			const TypeInfo* types[] = { Get<Components>()... };
+			int columns[sizeof...(Components)];
+			for (auto& a : m_Archetypes)
+			{
+				Archetype& archetype = *a.second;
+				if (archetype.m_Entities.empty())
+					continue;
+
+				bool match = true;
+				for (size_t i = 0; match && i != sizeof...(Components); ++i)
+					match = (columns[i] = archetype.FindColumn(types[i])) >= 0;
+				if (match)
+					EachRow<Components...>(archetype, columns, fn, std::index_sequence_for<Components...>());
+			}
+		}
+	};
+}
\ No newline at end of file
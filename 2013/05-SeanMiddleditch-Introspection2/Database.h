@@ -0,0 +1,576 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+#include "Serialize.h"
+
+#include <string>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#	if !defined(WIN32_LEAN_AND_MEAN)
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	if !defined(NOMINMAX)
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace Meta
+{
+	//! \brief A precompiled, read-only copy of every registered type, for tools that need the type information of a
+	//! program without linking it and running its META_DEFINE initializers.
+	//! Export writes the names, sizes, bases, members and methods with their signatures into flat tables with hashed
+	//! indices. Open maps such a file into memory and answers lookups straight from the mapped tables, so opening costs
+	//! one validation pass and nothing is built or copied. Types are referred to by their index in the type table. The
+	//! file is in the byte order and layout of the program that wrote it.
+	class Database
+	{
+	public:
+		static const uint32_t None = 0xFFFFFFFFu; //!< Index of no type, such as the return type of a void method.
+		static const uint32_t Version = 1; //!< Version of the file layout.
+
+		//! \brief Flags of a TypeEntry.
+		enum TypeFlags
+		{
+			TriviallyCopyable = 1, //!< Objects can be copied as raw bytes.
+			Constructible = 2, //!< Objects can be default constructed.
+		};
+
+		//! \brief A table in the file.
+		struct Table
+		{
+			uint32_t count; //!< Number of entries.
+			uint32_t offset; //!< Offset of the first entry from the start of the file.
+		};
+
+		//! \brief The start of the file.
+		struct Header
+		{
+			char magic[4]; //!< "MTDB".
+			uint32_t order; //!< 0x01020304 in the byte order of the writer.
+			uint32_t version; //!< Version.
+			uint32_t size; //!< Total size of the file in bytes.
+			Table types; //!< TypeEntry table, in order of definition.
+			Table bases; //!< BaseEntry table, grouped by deriving type.
+			Table members; //!< MemberEntry table, grouped by owner.
+			Table methods; //!< MethodEntry table, grouped by owner.
+			Table params; //!< ParamEntry table, grouped by method.
+			Table typeSlots; //!< Open-addressed index of TypeEntry index + 1 by name, 0 for an empty slot.
+			Table memberSlots; //!< Open-addressed index of MemberEntry index + 1 by owner and name.
+			Table methodSlots; //!< Open-addressed index of MethodEntry index + 1 by owner and name.
+			Table strings; //!< Pool of nul-terminated names, count being its size in bytes.
+		};
+
+		//! \brief A type.
+		struct TypeEntry
+		{
+			uint32_t name; //!< Offset of the name in the string pool.
+			uint32_t hash; //!< Hash of the name.
+			uint32_t size; //!< Size in bytes.
+			uint32_t alignment; //!< Alignment in bytes.
+			uint32_t flags; //!< TypeFlags.
+			uint32_t firstBase; //!< Index of the first direct base.
+			uint32_t baseCount; //!< Number of direct bases.
+			uint32_t firstMember; //!< Index of the first member declared by the type.
+			uint32_t memberCount; //!< Number of members declared by the type.
+			uint32_t firstMethod; //!< Index of the first method declared by the type.
+			uint32_t methodCount; //!< Number of methods declared by the type.
+		};
+
+		//! \brief A direct base of a type.
+		struct BaseEntry
+		{
+			uint32_t type; //!< Index of the base.
+			int32_t offset; //!< Offset of the base within the deriving type.
+		};
+
+		//! \brief A member of a type.
+		struct MemberEntry
+		{
+			uint32_t name; //!< Offset of the name in the string pool.
+			uint32_t hash; //!< Hash of the name.
+			uint32_t owner; //!< Index of the declaring type.
+			uint32_t type; //!< Index of the type of the member.
+			int32_t offset; //!< Offset within the owner, or -1 if accessed through functions.
+			uint32_t isMutable; //!< 1 if the member can be set.
+		};
+
+		//! \brief The return type or a parameter type of a method.
+		struct ParamEntry
+		{
+			uint32_t type; //!< Index of the type, or None for void.
+			uint32_t qualifier; //!< A TypeRecord::Qualifier.
+		};
+
+		//! \brief A method of a type.
+		struct MethodEntry
+		{
+			uint32_t name; //!< Offset of the name in the string pool.
+			uint32_t hash; //!< Hash of the name.
+			uint32_t owner; //!< Index of the declaring type.
+			uint32_t arity; //!< Number of parameters.
+			uint32_t firstParam; //!< Index of the return type, which the parameter types follow.
+		};
+
+	private:
+		const char* m_Data; //!< The file contents.
+		size_t m_Size; //!< Size of the file contents in bytes.
+		bool m_Mapped; //!< Whether m_Data is a mapping owned by the database.
+
+		Database(const Database&); // = delete
+		void operator=(const Database&); // = delete
+
+		const Header& GetHeader() const { return *reinterpret_cast<const Header*>(m_Data); }
+
+		template <typename Entry> const Entry* GetTable(const Table& table) const { return reinterpret_cast<const Entry*>(m_Data + table.offset); }
+
+		//! \brief Hashes an owner index and name hash into a member or method slot.
+		static uint32_t HashOwned(uint32_t owner, uint32_t hash) { return hash ^ (owner * 2654435761u); }
+
+		//! \brief The hash stored for a name; the low bits of hash_name, which equal 32-bit FNV-1a.
+		static uint32_t HashName(const char* name) { return static_cast<uint32_t>(internal::hash_name(name)); }
+
+		//! \brief Builds an open-addressed index; the first entry with a given key wins.
+		template <typename Key, typename Equal> static std::vector<uint32_t> BuildSlots(size_t count, Key key, Equal equal)
+		{
+			size_t size = 4;
+			while (size < count * 2)
+				size *= 2;
+
+			std::vector<uint32_t> slots(size, 0);
+			for (size_t e = 0; e != count; ++e)
+			{
+				size_t i = key(e) & (size - 1);
+				while (slots[i] != 0 && !equal(slots[i] - 1, e))
+					i = (i + 1) & (size - 1);
+				if (slots[i] == 0)
+					slots[i] = static_cast<uint32_t>(e + 1);
+			}
+			return slots;
+		}
+
+		//! \brief Checks that a table lies within the file and is aligned for its entries.
+		bool IsValid(const Table& table, size_t entrySize) const
+		{
+			return table.offset % sizeof(uint32_t) == 0 && table.offset <= m_Size && table.count <= (m_Size - table.offset) / entrySize;
+		}
+
+		//! \brief Checks that an open-addressed index lies within the file, refers to valid entries and can be probed.
+		bool IsValidIndex(const Table& table, uint32_t entries) const
+		{
+			if (!IsValid(table, sizeof(uint32_t)) || table.count == 0 || (table.count & (table.count - 1)) != 0)
+				return false;
+
+			bool empty = false;
+			const uint32_t* slots = GetTable<uint32_t>(table);
+			for (uint32_t i = 0; i != table.count; ++i)
+			{
+				if (slots[i] > entries)
+					return false;
+				empty |= slots[i] == 0;
+			}
+			return empty; // probes stop at an empty slot
+		}
+
+		bool IsValidName(uint32_t name) const { return name < GetHeader().strings.count; }
+		bool IsValidType(uint32_t type) const { return type < GetHeader().types.count; }
+		bool IsValidRange(uint32_t first, uint32_t count, const Table& table) const { return first <= table.count && count <= table.count - first; }
+
+		//! \brief Checks that no type is its own base, which would make the lookups recurse forever.
+		bool IsAcyclic(uint32_t type, std::vector<char>& state) const
+		{
+			if (state[type] == 2)
+				return true;
+			if (state[type] == 1)
+				return false;
+
+			state[type] = 1;
+			const TypeEntry& t = GetTable<TypeEntry>(GetHeader().types)[type];
+			for (uint32_t i = 0; i != t.baseCount; ++i)
+				if (!IsAcyclic(GetTable<BaseEntry>(GetHeader().bases)[t.firstBase + i].type, state))
+					return false;
+			state[type] = 2;
+			return true;
+		}
+
+		//! \brief Checks every table and reference so that lookups need no checks.
+		bool Validate() const
+		{
+			if (m_Size < sizeof(Header) || reinterpret_cast<uintptr_t>(m_Data) % sizeof(uint32_t) != 0)
+				return false;
+
+			const Header& h = GetHeader();
+			if (std::memcmp(h.magic, "MTDB", 4) != 0 || h.order != 0x01020304u || h.version != Version || h.size != m_Size)
+				return false;
+
+			if (!IsValid(h.types, sizeof(TypeEntry)) || !IsValid(h.bases, sizeof(BaseEntry)) || !IsValid(h.members, sizeof(MemberEntry)) ||
+				!IsValid(h.methods, sizeof(MethodEntry)) || !IsValid(h.params, sizeof(ParamEntry)) || !IsValid(h.strings, 1) ||
+				!IsValidIndex(h.typeSlots, h.types.count) || !IsValidIndex(h.memberSlots, h.members.count) || !IsValidIndex(h.methodSlots, h.methods.count))
+				return false;
+
+			// every name must end within the pool
+			if (h.strings.count == 0 || m_Data[h.strings.offset + h.strings.count - 1] != 0)
+				return false;
+
+			const TypeEntry* types = GetTable<TypeEntry>(h.types);
+			for (uint32_t i = 0; i != h.types.count; ++i)
+			{
+				const TypeEntry& t = types[i];
+				if (!IsValidName(t.name) || !IsValidRange(t.firstBase, t.baseCount, h.bases) || !IsValidRange(t.firstMember, t.memberCount, h.members) || !IsValidRange(t.firstMethod, t.methodCount, h.methods))
+					return false;
+			}
+
+			const BaseEntry* bases = GetTable<BaseEntry>(h.bases);
+			for (uint32_t i = 0; i != h.bases.count; ++i)
+				if (!IsValidType(bases[i].type))
+					return false;
+
+			const MemberEntry* members = GetTable<MemberEntry>(h.members);
+			for (uint32_t i = 0; i != h.members.count; ++i)
+				if (!IsValidName(members[i].name) || !IsValidType(members[i].owner) || (members[i].type != None && !IsValidType(members[i].type)))
+					return false;
+
+			const MethodEntry* methods = GetTable<MethodEntry>(h.methods);
+			for (uint32_t i = 0; i != h.methods.count; ++i)
+				if (!IsValidName(methods[i].name) || !IsValidType(methods[i].owner) || methods[i].arity == None || !IsValidRange(methods[i].firstParam, methods[i].arity + 1, h.params))
+					return false;
+
+			const ParamEntry* params = GetTable<ParamEntry>(h.params);
+			for (uint32_t i = 0; i != h.params.count; ++i)
+				if (params[i].type != None && !IsValidType(params[i].type))
+					return false;
+
+			std::vector<char> state(h.types.count, 0);
+			for (uint32_t i = 0; i != h.types.count; ++i)
+				if (!IsAcyclic(i, state))
+					return false;
+
+			return true;
+		}
+
+		//! \brief Finds an entry declared by a type in a member or method index.
+		template <typename Entry> const Entry* FindOwned(const Table& slotTable, const Table& entryTable, uint32_t owner, const char* name, uint32_t hash) const
+		{
+			const uint32_t* slots = GetTable<uint32_t>(slotTable);
+			const Entry* entries = GetTable<Entry>(entryTable);
+			const uint32_t mask = slotTable.count - 1;
+			for (uint32_t i = HashOwned(owner, hash) & mask; slots[i] != 0; i = (i + 1) & mask)
+			{
+				const Entry& e = entries[slots[i] - 1];
+				if (e.hash == hash && e.owner == owner && std::strcmp(GetString(e.name), name) == 0)
+					return &e;
+			}
+			return nullptr;
+		}
+
+		//! \brief Finds an entry in a type or, in declaration order, its bases, accumulating the base offsets.
+		template <typename Entry> const Entry* FindInherited(const Table& slotTable, const Table& entryTable, uint32_t type, const char* name, uint32_t hash, ptrdiff_t& offset) const
+		{
+			if (auto e = FindOwned<Entry>(slotTable, entryTable, type, name, hash))
+				return e;
+
+			const TypeEntry& t = *GetType(type);
+			for (uint32_t i = 0; i != t.baseCount; ++i)
+			{
+				const BaseEntry& b = *GetBase(t, i);
+				ptrdiff_t inner = 0;
+				if (auto e = FindInherited<Entry>(slotTable, entryTable, b.type, name, hash, inner))
+				{
+					offset += b.offset + inner;
+					return e;
+				}
+			}
+			return nullptr;
+		}
+
+	public:
+		Database() : m_Data(nullptr), m_Size(0), m_Mapped(false) { }
+		~Database() { Close(); }
+
+		//! \brief Writes every registered type to a database.
+		static void Export(Writer& out)
+		{
+			const auto& registered = Registry::Instance().GetTypes();
+			std::unordered_map<const TypeInfo*, uint32_t> indices;
+			for (auto t : registered)
+				indices.insert(std::make_pair(t, static_cast<uint32_t>(indices.size())));
+			auto indexOf = [&indices](const TypeInfo* type) { auto i = indices.find(type); return i != indices.end() ? i->second : None; };
+
+			std::string strings;
+			std::unordered_map<std::string, uint32_t> interned;
+			auto intern = [&strings, &interned](const char* name) -> uint32_t
+			{
+				auto i = interned.find(name);
+				if (i != interned.end())
+					return i->second;
+				const uint32_t offset = static_cast<uint32_t>(strings.size());
+				strings.append(name, std::strlen(name) + 1);
+				interned.insert(std::make_pair(std::string(name), offset));
+				return offset;
+			};
+
+			std::vector<TypeEntry> types;
+			std::vector<BaseEntry> bases;
+			std::vector<MemberEntry> members;
+			std::vector<MethodEntry> methods;
+			std::vector<ParamEntry> params;
+			for (auto type : registered)
+			{
+				const uint32_t index = static_cast<uint32_t>(types.size());
+				TypeEntry t = TypeEntry();
+				t.name = intern(type->GetName());
+				t.hash = HashName(type->GetName());
+				t.size = static_cast<uint32_t>(type->GetSize());
+				t.alignment = static_cast<uint32_t>(type->GetAlignment());
+				t.flags = (type->IsTriviallyCopyable() ? TriviallyCopyable : 0) | (type->CanConstruct() ? Constructible : 0);
+
+				t.firstBase = static_cast<uint32_t>(bases.size());
+				for (auto& b : type->GetBases())
+				{
+					const uint32_t base = indexOf(b.type);
+					if (base == None)
+						continue;
+					BaseEntry e = { base, static_cast<int32_t>(b.offset) };
+					bases.push_back(e);
+				}
+				t.baseCount = static_cast<uint32_t>(bases.size()) - t.firstBase;
+
+				t.firstMember = static_cast<uint32_t>(members.size());
+				for (auto m : type->GetMembers())
+				{
+					MemberEntry e = { intern(m->GetName()), HashName(m->GetName()), index, indexOf(m->GetType()), static_cast<int32_t>(m->GetOffset()), m->IsMutable() ? 1u : 0u };
+					members.push_back(e);
+				}
+				t.memberCount = static_cast<uint32_t>(members.size()) - t.firstMember;
+
+				t.firstMethod = static_cast<uint32_t>(methods.size());
+				for (auto m : type->GetMethods())
+				{
+					MethodEntry e = { intern(m->GetName()), HashName(m->GetName()), index, static_cast<uint32_t>(m->GetArity()), static_cast<uint32_t>(params.size()) };
+					methods.push_back(e);
+
+					const TypeRecord r = m->GetReturnType();
+					ParamEntry p = { indexOf(r.type), static_cast<uint32_t>(r.qualifier) };
+					params.push_back(p);
+					for (int i = 0; i != m->GetArity(); ++i)
+					{
+						const TypeRecord tr = m->GetParamType(i);
+						ParamEntry pe = { indexOf(tr.type), static_cast<uint32_t>(tr.qualifier) };
+						params.push_back(pe);
+					}
+				}
+				t.methodCount = static_cast<uint32_t>(methods.size()) - t.firstMethod;
+
+				types.push_back(t);
+			}
+
+			auto typeSlots = BuildSlots(types.size(),
+				[&types](size_t e) { return types[e].hash; },
+				[&types, &strings](size_t a, size_t b) { return std::strcmp(&strings[types[a].name], &strings[types[b].name]) == 0; });
+			auto memberSlots = BuildSlots(members.size(),
+				[&members](size_t e) { return HashOwned(members[e].owner, members[e].hash); },
+				[&members, &strings](size_t a, size_t b) { return members[a].owner == members[b].owner && std::strcmp(&strings[members[a].name], &strings[members[b].name]) == 0; });
+			auto methodSlots = BuildSlots(methods.size(),
+				[&methods](size_t e) { return HashOwned(methods[e].owner, methods[e].hash); },
+				[&methods, &strings](size_t a, size_t b) { return methods[a].owner == methods[b].owner && std::strcmp(&strings[methods[a].name], &strings[methods[b].name]) == 0; });
+
+			// the tables follow the header in this order; every entry is a multiple of 4 bytes, so only the end is padded
+			std::vector<char> file(sizeof(Header));
+			auto append = [&file](Table& table, const void* data, size_t count, size_t entrySize)
+			{
+				table.count = static_cast<uint32_t>(count);
+				table.offset = static_cast<uint32_t>(file.size());
+				file.insert(file.end(), static_cast<const char*>(data), static_cast<const char*>(data) + count * entrySize);
+			};
+
+			Header h = Header();
+			std::memcpy(h.magic, "MTDB", 4);
+			h.order = 0x01020304u;
+			h.version = Version;
+			append(h.types, types.data(), types.size(), sizeof(TypeEntry));
+			append(h.bases, bases.data(), bases.size(), sizeof(BaseEntry));
+			append(h.members, members.data(), members.size(), sizeof(MemberEntry));
+			append(h.methods, methods.data(), methods.size(), sizeof(MethodEntry));
+			append(h.params, params.data(), params.size(), sizeof(ParamEntry));
+			append(h.typeSlots, typeSlots.data(), typeSlots.size(), sizeof(uint32_t));
+			append(h.memberSlots, memberSlots.data(), memberSlots.size(), sizeof(uint32_t));
+			append(h.methodSlots, methodSlots.data(), methodSlots.size(), sizeof(uint32_t));
+			strings.push_back(0); // keeps the pool non-empty
+			append(h.strings, strings.data(), strings.size(), 1);
+			file.resize((file.size() + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1));
+			h.size = static_cast<uint32_t>(file.size());
+			std::memcpy(file.data(), &h, sizeof(Header));
+
+			out.Write(file.data(), file.size());
+		}
+
+		//! \brief Maps a database file into memory, closing any open database.
+		//! \returns False if the file cannot be mapped or is not a valid database of this version and byte order.
+		bool Open(const char* path)
+		{
+			Close();
+
+			void* data = nullptr;
+			size_t size = 0;
+#if defined(_WIN32)
+			HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return false;
+			LARGE_INTEGER length;
+			if (GetFileSizeEx(file, &length) && length.QuadPart > 0)
+			{
+				// the view keeps the mapping alive after its handle is closed
+				HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping != nullptr)
+				{
+					data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+					size = static_cast<size_t>(length.QuadPart);
+					CloseHandle(mapping);
+				}
+			}
+			CloseHandle(file);
+#else
+			const int file = ::open(path, O_RDONLY);
+			if (file < 0)
+				return false;
+			struct stat st;
+			if (::fstat(file, &st) == 0 && st.st_size > 0)
+			{
+				data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+				size = static_cast<size_t>(st.st_size);
+				if (data == MAP_FAILED)
+					data = nullptr;
+			}
+			::close(file);
+#endif
+			if (data == nullptr)
+				return false;
+
+			m_Data = static_cast<const char*>(data);
+			m_Size = size;
+			m_Mapped = true;
+			if (Validate())
+				return true;
+			Close();
+			return false;
+		}
+
+		//! \brief Uses a database already in memory, closing any open database.
+		//! \param data The database, 4-byte aligned, which must outlive its use.
+		//! \returns False if the data is not a valid database of this version and byte order.
+		bool Open(const void* data, size_t size)
+		{
+			Close();
+			m_Data = static_cast<const char*>(data);
+			m_Size = size;
+			if (Validate())
+				return true;
+			Close();
+			return false;
+		}
+
+		//! \brief Closes the database, unmapping its file.
+		void Close()
+		{
+			if (m_Mapped)
+			{
+#if defined(_WIN32)
+				UnmapViewOfFile(m_Data);
+#else
+				::munmap(const_cast<char*>(m_Data), m_Size);
+#endif
+			}
+			m_Data = nullptr;
+			m_Size = 0;
+			m_Mapped = false;
+		}
+
+		//! \brief Checks if a database is open.
+		bool IsOpen() const { return m_Data != nullptr; }
+
+		//! \brief Retrieves the number of types.
+		uint32_t GetTypeCount() const { return IsOpen() ? GetHeader().types.count : 0; }
+
+		//! \brief Retrieves a type by index.
+		//! \returns The type, or nullptr for None.
+		const TypeEntry* GetType(uint32_t index) const { return index != None ? &GetTable<TypeEntry>(GetHeader().types)[index] : nullptr; }
+
+		//! \brief Retrieves the index of a type.
+		uint32_t GetIndex(const TypeEntry& type) const { return static_cast<uint32_t>(&type - GetTable<TypeEntry>(GetHeader().types)); }
+
+		//! \brief Retrieves a direct base of a type, i being less than its baseCount.
+		const BaseEntry* GetBase(const TypeEntry& type, uint32_t i) const { return &GetTable<BaseEntry>(GetHeader().bases)[type.firstBase + i]; }
+
+		//! \brief Retrieves a member declared by a type, i being less than its memberCount.
+		const MemberEntry* GetMember(const TypeEntry& type, uint32_t i) const { return &GetTable<MemberEntry>(GetHeader().members)[type.firstMember + i]; }
+
+		//! \brief Retrieves a method declared by a type, i being less than its methodCount.
+		const MethodEntry* GetMethod(const TypeEntry& type, uint32_t i) const { return &GetTable<MethodEntry>(GetHeader().methods)[type.firstMethod + i]; }
+
+		//! \brief Retrieves the return type of a method.
+		const ParamEntry* GetReturn(const MethodEntry& method) const { return &GetTable<ParamEntry>(GetHeader().params)[method.firstParam]; }
+
+		//! \brief Retrieves a parameter type of a method, i being less than its arity.
+		const ParamEntry* GetParam(const MethodEntry& method, uint32_t i) const { return &GetTable<ParamEntry>(GetHeader().params)[method.firstParam + 1 + i]; }
+
+		//! \brief Retrieves a string from the pool, such as the name of an entry.
+		const char* GetString(uint32_t offset) const { return m_Data + GetHeader().strings.offset + offset; }
+
+		//! \brief Retrieves the name of a type, member or method.
+		template <typename Entry> const char* GetName(const Entry& entry) const { return GetString(entry.name); }
+
+		//! \brief Finds a type by name.
+		//! \returns The first type defined with that name, or nullptr if there is none.
+		const TypeEntry* FindType(const char* name) const
+		{
+			if (!IsOpen())
+				return nullptr;
+
+			const Header& h = GetHeader();
+			const uint32_t* slots = GetTable<uint32_t>(h.typeSlots);
+			const uint32_t hash = HashName(name);
+			const uint32_t mask = h.typeSlots.count - 1;
+			for (uint32_t i = hash & mask; slots[i] != 0; i = (i + 1) & mask)
+			{
+				const TypeEntry& t = *GetType(slots[i] - 1);
+				if (t.hash == hash && std::strcmp(GetString(t.name), name) == 0)
+					return &t;
+			}
+			return nullptr;
+		}
+
+		//! \brief Finds a member of a type or one of its bases, like TypeInfo::FindMemberEntry.
+		//! \param offset Receives the offset of the member's owner within the type.
+		//! \returns The member, or nullptr if there is none with that name.
+		const MemberEntry* FindMember(const TypeEntry& type, const char* name, ptrdiff_t& offset) const
+		{
+			offset = 0;
+			return FindInherited<MemberEntry>(GetHeader().memberSlots, GetHeader().members, GetIndex(type), name, HashName(name), offset);
+		}
+
+		//! \brief Finds a member of a type or one of its bases.
+		const MemberEntry* FindMember(const TypeEntry& type, const char* name) const { ptrdiff_t offset; return FindMember(type, name, offset); }
+
+		//! \brief Finds a method of a type or one of its bases, like TypeInfo::FindMethodEntry.
+		//! \param offset Receives the offset of the method's owner within the type.
+		//! \returns The method, or nullptr if there is none with that name.
+		const MethodEntry* FindMethod(const TypeEntry& type, const char* name, ptrdiff_t& offset) const
+		{
+			offset = 0;
+			return FindInherited<MethodEntry>(GetHeader().methodSlots, GetHeader().methods, GetIndex(type), name, HashName(name), offset);
+		}
+
+		//! \brief Finds a method of a type or one of its bases.
+		const MethodEntry* FindMethod(const TypeEntry& type, const char* name) const { ptrdiff_t offset; return FindMethod(type, name, offset); }
+	};
+}
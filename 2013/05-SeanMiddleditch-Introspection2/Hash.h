@@ -0,0 +1,228 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace Meta
+{
+	namespace internal
+	{
+		inline uint64_t hash_rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+		inline uint64_t hash_read64(const unsigned char* p) { uint64_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+		inline uint32_t hash_read32(const unsigned char* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+		//! \brief Mixes one 64-bit lane of input into an accumulator.
+		inline uint64_t hash_round(uint64_t acc, uint64_t input)
+		{
+			acc += input * 14029467366897019727ULL;
+			return hash_rotl(acc, 31) * 11400714785074694791ULL;
+		}
+
+		inline uint64_t hash_merge(uint64_t acc, uint64_t lane)
+		{
+			acc ^= hash_round(0, lane);
+			return acc * 11400714785074694791ULL + 9650029242287828579ULL;
+		}
+
+		//! \brief Hashes bytes with the XXH64 algorithm, which consumes 32 bytes per step in four independent lanes.
+		inline uint64_t hash_bytes(const void* data, size_t size, uint64_t seed)
+		{
+			const uint64_t P1 = 11400714785074694791ULL, P2 = 14029467366897019727ULL, P3 = 1609587929392839161ULL, P4 = 9650029242287828579ULL, P5 = 2870177450012600261ULL;
+			const unsigned char* p = static_cast<const unsigned char*>(data);
+			const unsigned char* const end = p + size;
+			uint64_t h;
+
+			if (size >= 32)
+			{
+				uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+				for (const unsigned char* limit = end - 32; p <= limit; p += 32)
+				{
+					v1 = hash_round(v1, hash_read64(p));
+					v2 = hash_round(v2, hash_read64(p + 8));
+					v3 = hash_round(v3, hash_read64(p + 16));
+					v4 = hash_round(v4, hash_read64(p + 24));
+				}
+				h = hash_rotl(v1, 1) + hash_rotl(v2, 7) + hash_rotl(v3, 12) + hash_rotl(v4, 18);
+				h = hash_merge(h, v1);
+				h = hash_merge(h, v2);
+				h = hash_merge(h, v3);
+				h = hash_merge(h, v4);
+			}
+			else
+			{
+				h = seed + P5;
+			}
+
+			h += size;
+			for (; p + 8 <= end; p += 8)
+				h = hash_rotl(h ^ hash_round(0, hash_read64(p)), 27) * P1 + P4;
+			if (p + 4 <= end)
+			{
+				h = hash_rotl(h ^ (hash_read32(p) * P1), 23) * P2 + P3;
+				p += 4;
+			}
+			for (; p != end; ++p)
+				h = hash_rotl(h ^ (*p * P5), 11) * P1;
+
+			h ^= h >> 33;
+			h *= P2;
+			h ^= h >> 29;
+			h *= P3;
+			h ^= h >> 32;
+			return h;
+		}
+
+		//! \brief Hash and equality for a type, used by Hasher::SetComparer<Type>().  Specialize for other types.
+		template <typename Type> struct comparer;
+
+		//! \brief Hash and equality for std::string, over the characters.
+		template <> struct comparer<std::string>
+		{
+			static uint64_t hash(const std::string& value, uint64_t seed) { return hash_bytes(value.data(), value.size(), seed); }
+			static bool equals(const std::string& lhs, const std::string& rhs) { return lhs == rhs; }
+		};
+
+		//! \brief Adapts internal::comparer<Type> to Hasher::Comparer.
+		template <typename Type> struct comparer_thunk
+		{
+			static uint64_t hash(const void* obj, uint64_t seed) { return comparer<Type>::hash(*static_cast<const Type*>(obj), seed); }
+			static bool equals(const void* lhs, const void* rhs) { return comparer<Type>::equals(*static_cast<const Type*>(lhs), *static_cast<const Type*>(rhs)); }
+		};
+	}
+
+	//! \brief Hashes and compares reflected objects by the values of their members.
+	//! Each type is compiled once into a FieldPlan over its own and inherited members, like the Serializer's. Adjacent
+	//! trivially copyable fields are merged into runs that are hashed and compared as bytes, so padding between members
+	//! is never read; types with a comparer (such as std::string) use it, and members accessed through getter functions
+	//! go through Member::Get. A type with a value none of these can handle cannot be hashed, rather than hashed without
+	//! it. Byte runs compare floats by representation, so 0.0 and -0.0 differ and a NaN equals itself.
+	class Hasher
+	{
+	public:
+		//! \brief Hashes and compares a type that cannot be treated as raw bytes.
+		struct Comparer
+		{
+			uint64_t (*hash)(const void* obj, uint64_t seed); //!< Hashes the object, continuing from seed.
+			bool (*equals)(const void* lhs, const void* rhs); //!< Compares two objects.
+		};
+
+		//! \brief The compiled steps for a type, in order.
+		typedef FieldPlan<Comparer> Plan;
+
+		//! \brief One step of a Plan.
+		typedef Plan::Step Step;
+
+	private:
+		std::unordered_map<const TypeInfo*, Comparer> m_Comparers; //!< Comparers by type.
+		internal::plan_cache<std::unordered_map<const TypeInfo*, Plan>> m_Plans; //!< Compiled plans by type, built on first use.
+
+		Hasher() { }
+		Hasher(const Hasher&); // = delete
+		void operator=(const Hasher&); // = delete
+
+	public:
+		//! \brief Retrieves the hasher.
+		static Hasher& Instance() { static Hasher s_Hasher; return s_Hasher; }
+
+		//! \brief Sets the comparer for a type.  Must be done before any plan using the type is compiled.
+		void SetComparer(const TypeInfo* type, const Comparer& comparer)
+		{
+			auto lock = m_Plans.Lock();
+			m_Comparers[type] = comparer;
+		}
+
+		//! \brief Sets the comparer for a type to internal::comparer<Type>.
+		template <typename Type> void SetComparer()
+		{
+			Comparer comparer = { &internal::comparer_thunk<Type>::hash, &internal::comparer_thunk<Type>::equals };
+			SetComparer(Get<Type>(), comparer);
+		}
+
+		//! \brief Retrieves the plan for a type, compiling it on first use.  Safe to call from any thread.
+		const Plan& GetPlan(const TypeInfo* type) { return m_Plans.Get(type, [this, type]() { return Plan::Compile(type, m_Comparers, false); }); }
+
+		//! \brief Checks that objects of a type can be hashed and compared: every value in them has a comparer, reflected
+		//! members or a trivial copy.
+		bool CanHash(const TypeInfo* type) { return GetPlan(type).IsComplete(); }
+
+		//! \brief Hashes an object.
+		//! \param type The exact type of the object, for which CanHash must hold.
+		//! \param obj The object.
+		//! \param seed A starting value, e.g. the hash of preceding data.
+		uint64_t Hash(const TypeInfo* type, const void* obj, uint64_t seed = 0)
+		{
+			const Plan& plan = GetPlan(type);
+			assert(plan.IsComplete() && "type has a value that cannot be hashed; check with CanHash");
+
+			const char* base = static_cast<const char*>(obj);
+			uint64_t h = seed;
+			for (auto& s : plan)
+			{
+				switch (s.kind)
+				{
+				case Step::Bytes:
+					h = internal::hash_bytes(base + s.offset, s.size, h);
+					break;
+				case Step::Field:
+					h = s.handler->hash(base + s.offset, h);
+					break;
+				case Step::Property:
+					{
+						Any value = s.member->Get(Any(static_cast<const void*>(base + s.offset), s.owner));
+						h = Hash(s.type, value.GetPointer(), h);
+					}
+					break;
+				}
+			}
+			return h;
+		}
+
+		//! \brief Compares two objects of the same type.
+		//! \param type The exact type of both objects, for which CanHash must hold.
+		bool Equals(const TypeInfo* type, const void* lhs, const void* rhs)
+		{
+			const Plan& plan = GetPlan(type);
+			assert(plan.IsComplete() && "type has a value that cannot be compared; check with CanHash");
+
+			const char* a = static_cast<const char*>(lhs);
+			const char* b = static_cast<const char*>(rhs);
+			for (auto& s : plan)
+			{
+				switch (s.kind)
+				{
+				case Step::Bytes:
+					if (std::memcmp(a + s.offset, b + s.offset, s.size) != 0)
+						return false;
+					break;
+				case Step::Field:
+					if (!s.handler->equals(a + s.offset, b + s.offset))
+						return false;
+					break;
+				case Step::Property:
+					{
+						Any va = s.member->Get(Any(static_cast<const void*>(a + s.offset), s.owner));
+						Any vb = s.member->Get(Any(static_cast<const void*>(b + s.offset), s.owner));
+						if (!Equals(s.type, va.GetPointer(), vb.GetPointer()))
+							return false;
+					}
+					break;
+				}
+			}
+			return true;
+		}
+
+		//! \brief Hashes an object of a statically known type.
+		template <typename Type> uint64_t Hash(const Type& obj, uint64_t seed = 0) { return Hash(Get<Type>(), &obj, seed); }
+
+		//! \brief Compares two objects of a statically known type.
+		template <typename Type> bool Equals(const Type& lhs, const Type& rhs) { return Equals(Get<Type>(), &lhs, &rhs); }
+	};
+}
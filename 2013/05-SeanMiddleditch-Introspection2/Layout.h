@@ -0,0 +1,288 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace Meta
+{
+	//! \brief Describes the memory layout of a reflected type: its plain data members, including inherited ones, the
+	//! offsets of its bases, the gaps between members, and the members that straddle a cache line. It also suggests an
+	//! order of the type's own members that minimizes padding and, given access counts, which members are hot or cold.
+	//! Only reflected members are known, so a gap is padding or unreflected data such as a vtable pointer; members
+	//! accessed through getter and setter functions have no storage and are left out.
+	class Layout
+	{
+	public:
+		//! \brief A plain data member at its offset in the analyzed type.
+		struct Field
+		{
+			const Member* member; //!< The member.
+			ptrdiff_t offset; //!< Offset from the start of the analyzed type.
+			size_t size; //!< Size in bytes.
+			size_t alignment; //!< Alignment in bytes.
+			bool inherited; //!< Whether the member belongs to a base.
+			bool crossesLine; //!< Whether the member straddles a cache line, for an object starting on one.
+			unsigned long long accesses; //!< Access count from SetAccesses, or 0.
+		};
+
+		//! \brief Bytes not covered by any reflected member.
+		struct Gap
+		{
+			ptrdiff_t offset; //!< Offset of the first byte.
+			size_t size; //!< Number of bytes.
+		};
+
+		//! \brief A base, direct or indirect, at its offset in the analyzed type.
+		struct Base
+		{
+			const TypeInfo* type; //!< The base type.
+			ptrdiff_t offset; //!< Offset from the start of the analyzed type, from the BaseRecords along the way.
+			int depth; //!< 1 for a direct base, 2 for a base of a base, and so on.
+		};
+
+		//! \brief Access counts by member, e.g. from GetProfiledAccesses.
+		typedef std::map<const Member*, unsigned long long> Accesses;
+
+	private:
+		const TypeInfo* m_Type; //!< The analyzed type.
+		size_t m_LineSize; //!< The cache line size in bytes.
+		std::vector<Field> m_Fields; //!< Plain data members, ordered by offset.
+		std::vector<Gap> m_Gaps; //!< Uncovered bytes, ordered by offset.
+		std::vector<Base> m_Bases; //!< Bases, depth first in declaration order.
+
+		void CollectBases(const TypeInfo* type, ptrdiff_t offset, int depth)
+		{
+			for (auto& b : type->GetBases())
+			{
+				Base base = { b.type, offset + b.offset, depth + 1 };
+				m_Bases.push_back(base);
+				CollectBases(b.type, offset + b.offset, depth + 1);
+			}
+		}
+
+		void CollectFields(const TypeInfo* type)
+		{
+			for (auto& e : type->GetAllMembers())
+			{
+				auto m = e.item;
+				if (!m->IsField() || m->GetType() == nullptr)
+					continue;
+
+				Field f = Field();
+				f.member = m;
+				f.offset = e.offset + m->GetOffset();
+				f.size = m->GetType()->GetSize();
+				f.alignment = m->GetType()->GetAlignment();
+				f.inherited = m->GetOwner() != type;
+				f.crossesLine = f.size != 0 && static_cast<size_t>(f.offset) / m_LineSize != (static_cast<size_t>(f.offset) + f.size - 1) / m_LineSize;
+				m_Fields.push_back(f);
+			}
+		}
+
+		static size_t RoundUp(size_t value, size_t alignment) { return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value; }
+
+	public:
+		//! \brief Analyzes a type.
+		//! \param lineSize The cache line size in bytes.
+		explicit Layout(const TypeInfo* type, size_t lineSize = 64) : m_Type(type), m_LineSize(lineSize != 0 ? lineSize : 64)
+		{
+			CollectBases(type, 0, 0);
+			CollectFields(type);
+			std::stable_sort(m_Fields.begin(), m_Fields.end(), [](const Field& a, const Field& b) { return a.offset < b.offset; });
+
+			// members can overlap, e.g. in unions, so the covered range only ever grows
+			size_t covered = 0;
+			for (auto& f : m_Fields)
+			{
+				const size_t offset = static_cast<size_t>(f.offset);
+				if (offset > covered)
+				{
+					Gap g = { static_cast<ptrdiff_t>(covered), offset - covered };
+					m_Gaps.push_back(g);
+				}
+				covered = std::max(covered, offset + f.size);
+			}
+			if (covered < type->GetSize())
+			{
+				Gap g = { static_cast<ptrdiff_t>(covered), type->GetSize() - covered };
+				m_Gaps.push_back(g);
+			}
+		}
+
+		//! \brief Retrieves the analyzed type.
+		const TypeInfo* GetType() const { return m_Type; }
+
+		//! \brief Retrieves the cache line size used for the analysis.
+		size_t GetLineSize() const { return m_LineSize; }
+
+		//! \brief Retrieves the plain data members, including inherited ones, ordered by offset.
+		const std::vector<Field>& GetFields() const { return m_Fields; }
+
+		//! \brief Retrieves the bytes not covered by any reflected member, ordered by offset.
+		const std::vector<Gap>& GetGaps() const { return m_Gaps; }
+
+		//! \brief Retrieves every base with its offset, depth first in declaration order.
+		const std::vector<Base>& GetBases() const { return m_Bases; }
+
+		//! \brief Retrieves the total size of the gaps.
+		size_t GetGapBytes() const
+		{
+			size_t bytes = 0;
+			for (auto& g : m_Gaps)
+				bytes += g.size;
+			return bytes;
+		}
+
+		//! \brief Retrieves the number of cache lines an object spans when it starts on one.
+		size_t GetLineCount() const { return (m_Type->GetSize() + m_LineSize - 1) / m_LineSize; }
+
+		//! \brief Sets the access count of each member.  Members that are not listed count as never accessed.
+		void SetAccesses(const Accesses& accesses)
+		{
+			for (auto& f : m_Fields)
+			{
+				auto a = accesses.find(f.member);
+				f.accesses = a != accesses.end() ? a->second : 0;
+			}
+		}
+
+#if META_PROFILE
+		//! \brief Collects the member get and set counts of every profiled type, for SetAccesses.  Accesses through
+		//! TypedField handles and direct code are not counted.
+		static Accesses GetProfiledAccesses()
+		{
+			Accesses accesses;
+			Profiler::Instance().Each([&accesses](const TypeInfo* type, const char* name, Profiler::Event event, const Profiler::Counter& c)
+			{
+				if (type == nullptr || (event != Profiler::MemberGet && event != Profiler::MemberSet))
+					return;
+				for (auto m : type->GetMembers())
+					if (std::strcmp(m->GetName(), name) == 0)
+						accesses[m] += c.count;
+			});
+			return accesses;
+		}
+#endif
+
+		//! \brief Suggests an order of the type's own members that minimizes padding: by decreasing alignment, then size.
+		//! Bases and inherited members cannot move, so the members are placed from where the first one is now.
+		//! \param size Receives the size the type would have, assuming all of its data members are reflected.
+		//! \returns The own members in the suggested order.
+		std::vector<const Member*> SuggestOrder(size_t& size) const
+		{
+			std::vector<const Field*> own;
+			for (auto& f : m_Fields)
+				if (!f.inherited)
+					own.push_back(&f);
+
+			std::stable_sort(own.begin(), own.end(), [](const Field* a, const Field* b) { return a->alignment != b->alignment ? a->alignment > b->alignment : a->size > b->size; });
+
+			// the members start where the first one is now, after the bases and any vtable pointer
+			size_t cursor = m_Type->GetSize();
+			for (auto f : own)
+				cursor = std::min(cursor, static_cast<size_t>(f->offset));
+
+			std::vector<const Member*> order;
+			for (auto f : own)
+			{
+				cursor = RoundUp(cursor, f->alignment) + f->size;
+				order.push_back(f->member);
+			}
+			size = own.empty() ? m_Type->GetSize() : RoundUp(cursor, m_Type->GetAlignment());
+			return order;
+		}
+
+		//! \brief Splits the members into hot and cold by their access counts, from SetAccesses.  The most accessed
+		//! members are hot until they account for share of all accesses; members never accessed are always cold.
+		//! \param share The fraction of accesses, from 0 to 1, that the hot members must cover.
+		//! \param hot Receives the hot members, most accessed first.
+		//! \param cold Receives the cold members, most accessed first.
+		void SplitHotCold(double share, std::vector<const Field*>& hot, std::vector<const Field*>& cold) const
+		{
+			std::vector<const Field*> fields;
+			unsigned long long total = 0;
+			for (auto& f : m_Fields)
+			{
+				fields.push_back(&f);
+				total += f.accesses;
+			}
+			std::stable_sort(fields.begin(), fields.end(), [](const Field* a, const Field* b) { return a->accesses > b->accesses; });
+
+			hot.clear();
+			cold.clear();
+			unsigned long long covered = 0;
+			for (auto f : fields)
+			{
+				if (f->accesses != 0 && static_cast<double>(covered) < share * static_cast<double>(total))
+				{
+					hot.push_back(f);
+					covered += f->accesses;
+				}
+				else
+					cold.push_back(f);
+			}
+		}
+
+		//! \brief Writes a readable report: size, bases, members and gaps by offset, cache line crossings, the suggested
+		//! order and, if any accesses were set, the hot and cold members for 90% of accesses.
+		void Dump(std::ostream& out) const
+		{
+			out << "layout of " << m_Type->GetName() << ": " << m_Type->GetSize() << " bytes, aligned to " << m_Type->GetAlignment() << ", " << GetLineCount() << " cache line(s) of " << m_LineSize << " bytes\n";
+			for (auto& b : m_Bases)
+				out << std::string(2 * b.depth, ' ') << "base " << b.type->GetName() << " at " << b.offset << '\n';
+
+			auto gap = m_Gaps.begin();
+			for (auto& f : m_Fields)
+			{
+				for (; gap != m_Gaps.end() && gap->offset < f.offset; ++gap)
+					out << "  " << gap->offset << "\tgap of " << gap->size << '\n';
+				out << "  " << f.offset << '\t' << f.member->GetName() << " (" << f.member->GetType()->GetName() << ", " << f.size << " bytes";
+				if (f.inherited)
+					out << ", from " << f.member->GetOwner()->GetName();
+				if (f.crossesLine)
+					out << ", crosses a cache line";
+				if (f.accesses != 0)
+					out << ", " << f.accesses << " accesses";
+				out << ")\n";
+			}
+			for (; gap != m_Gaps.end(); ++gap)
+				out << "  " << gap->offset << "\tgap of " << gap->size << '\n';
+			out << "  " << GetGapBytes() << " bytes in " << m_Gaps.size() << " gap(s)\n";
+
+			size_t size;
+			auto order = SuggestOrder(size);
+			if (size < m_Type->GetSize())
+			{
+				out << "  suggested order:";
+				for (auto m : order)
+					out << ' ' << m->GetName();
+				out << " (" << size << " bytes, saves " << m_Type->GetSize() - size << ")\n";
+			}
+
+			std::vector<const Field*> hot, cold;
+			SplitHotCold(0.9, hot, cold);
+			if (!hot.empty())
+			{
+				size_t hotBytes = 0;
+				out << "  hot:";
+				for (auto f : hot)
+				{
+					out << ' ' << f->member->GetName();
+					hotBytes = RoundUp(hotBytes, f->alignment) + f->size;
+				}
+				out << " (" << hotBytes << " bytes packed)\n  cold:";
+				for (auto f : cold)
+					out << ' ' << f->member->GetName();
+				out << '\n';
+			}
+		}
+	};
+}
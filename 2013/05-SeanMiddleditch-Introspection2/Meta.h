@@ -2,15 +2,69 @@
 // All rights reserverd.  This code is intended for instructional use only and may not be used
 // in any commercial works nor in any student projects.
 
+#pragma once
+
 #include <type_traits>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
 #include <cstring>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#if !defined(META_ANY_INLINE_SIZE)
+//! \brief Bytes of inline storage in an Any.  Larger values are stored in blocks from a per-thread pool.
+#	define META_ANY_INLINE_SIZE (4 * sizeof(float))
+#endif
+
+#if !defined(META_ANY_ALIGNMENT)
+//! \brief Alignment of the inline storage of an Any.  Values that need more are stored in pooled blocks, which are aligned
+//! to 32 bytes.  Defaults to 16, enough for SSE and NEON vectors, on 64-bit targets whose heaps align to 16 bytes, and to 8
+//! elsewhere so that Anys in standard containers are always correctly aligned.
+#	if defined(_WIN64) || defined(__LP64__)
+#		define META_ANY_ALIGNMENT 16
+#	else
+#		define META_ANY_ALIGNMENT 8
+#	endif
+#endif
+
+#if !defined(META_PROFILE)
+//! \brief Set to 1 to count reflected lookups, accesses, calls and Any constructions per type (see Meta::Profiler).
+//! When 0 the instrumentation compiles to nothing.
+#	define META_PROFILE 0
+#endif
+
+#if META_PROFILE
+#	include <chrono>
+#	include <map>
+#	include <ostream>
+#	include <string>
+
+//! \brief Counts an event and times a sample of them until the end of the enclosing scope.
+#	define META_PROFILE_SCOPE(event, type, name) ::Meta::Profiler::Scope meta_profile_scope(::Meta::Profiler::event, (type), (name))
+//! \brief Changes the event of the enclosing META_PROFILE_SCOPE from a lookup hit to a miss.
+#	define META_PROFILE_MISS() meta_profile_scope.Miss()
+//! \brief Counts an event without timing it.
+#	define META_PROFILE_COUNT(event, type, name) ::Meta::Profiler::Instance().Record(::Meta::Profiler::event, (type), (name), 0, false)
+#else
+#	define META_PROFILE_SCOPE(event, type, name) ((void)0)
+#	define META_PROFILE_MISS() ((void)0)
+#	define META_PROFILE_COUNT(event, type, name) ((void)0)
+#endif
 
 //! Namespace that contains all introspection types and utilities.
 namespace Meta
 {
 	class TypeInfo;
+	struct StaticTypeInfo;
 
 	//! Namespace containing helper code
 	//! \internal
@@ -73,22 +127,491 @@ namespace Meta
 			ptrdiff_t offset; //<! Offset that must be applied to convert a pointer from the deriving type to this base
 		};
 
-		//! \brief Knows how to destruct a type.
-		template <typename Type> struct destructor
+		//! \brief Hashes a name for the lookup indices (FNV-1a).
+		inline size_t hash_name(const char* name)
+		{
+			size_t hash = 2166136261u;
+			while (*name != 0)
+				hash = (hash ^ static_cast<unsigned char>(*name++)) * 16777619u;
+			return hash;
+		}
+
+		//! \brief Hashes a name at compile time; equal to hash_name.
+		constexpr size_t hash_name_constant(const char* name, size_t hash = 2166136261u)
+		{
+			return *name != 0 ? hash_name_constant(name + 1, (hash ^ static_cast<unsigned char>(*name)) * 16777619u) : hash;
+		}
+
+		//! \brief A flattened, hashed name index over the members or methods of a type and all of its bases.
+		template <typename Item> class NameIndex
+		{
+		public:
+			//! \brief A named item reachable from the indexed type.
+			struct Entry
+			{
+				Entry(Item* i, ptrdiff_t o) : name(i->GetName()), hash(hash_name(name)), item(i), offset(o) { }
+
+				const char* name; //!< The name of the item
+				size_t hash; //!< Hash of the name
+				Item* item; //!< The member or method
+				ptrdiff_t offset; //!< Offset that must be applied to convert a pointer from the indexed type to the item's owner
+			};
+
+		private:
+			std::vector<Entry> m_Entries; //!< Entries in lookup order (own items first, then each base in turn)
+			std::vector<unsigned> m_Slots; //!< Open-addressed table of entry index + 1, 0 for an empty slot
+
+		public:
+			//! \brief Retrieves the entries in lookup order.
+			const std::vector<Entry>& GetEntries() const { return m_Entries; }
+
+			//! \brief Builds the index from candidates in lookup order; the first candidate with a given name wins.
+			void Build(const std::vector<Entry>& candidates)
+			{
+				size_t size = 4;
+				while (size < candidates.size() * 2)
+					size *= 2;
+
+				m_Slots.assign(size, 0);
+				m_Entries.clear();
+				m_Entries.reserve(candidates.size());
+
+				for (auto& c : candidates)
+				{
+					size_t i = c.hash & (size - 1);
+					while (m_Slots[i] != 0 && std::strcmp(m_Entries[m_Slots[i] - 1].name, c.name) != 0)
+						i = (i + 1) & (size - 1);
+					if (m_Slots[i] != 0)
+						continue; // hidden by an earlier entry
+
+					m_Entries.push_back(c);
+					m_Slots[i] = static_cast<unsigned>(m_Entries.size());
+				}
+			}
+
+			//! \brief Finds an entry by name.
+			//! \returns The entry or nullptr if no item has that name.
+			const Entry* Find(const char* name) const
+			{
+				if (m_Slots.empty())
+					return nullptr;
+
+				const size_t hash = hash_name(name);
+				const size_t mask = m_Slots.size() - 1;
+				for (size_t i = hash & mask; m_Slots[i] != 0; i = (i + 1) & mask)
+				{
+					const Entry& e = m_Entries[m_Slots[i] - 1];
+					if (e.hash == hash && std::strcmp(e.name, name) == 0)
+						return &e;
+				}
+
+				return nullptr;
+			}
+		};
+
+		//! \brief Bump allocator that keeps the Member and Method records of a type together in memory.
+		//! Records are never freed individually; Release frees every block at once.
+		class RecordArena
+		{
+			struct Block
+			{
+				Block* next; //!< The previously filled block
+				size_t size; //!< Bytes of storage following the header
+				size_t used; //!< Bytes of storage in use
+			};
+
+			static const size_t BlockSize = 1024; //!< Default storage per block, enough for the records of most types
+
+			Block* m_Head; //!< The block currently being filled
+
+			RecordArena(const RecordArena&); // = delete
+			void operator=(const RecordArena&); // = delete
+
+		public:
+			RecordArena() : m_Head(nullptr) { }
+			RecordArena(RecordArena&& src) : m_Head(src.m_Head) { src.m_Head = nullptr; }
+			~RecordArena() { Release(); }
+
+			//! \brief Allocates storage for a record.
+			void* Allocate(size_t size, size_t align)
+			{
+				if (m_Head != nullptr)
+				{
+					size_t offset = (m_Head->used + align - 1) & ~(align - 1);
+					if (offset + size <= m_Head->size)
+					{
+						m_Head->used = offset + size;
+						return reinterpret_cast<char*>(m_Head + 1) + offset;
+					}
+				}
+
+				// header size keeps the storage suitably aligned for any record
+				static_assert(sizeof(Block) % sizeof(void*) == 0, "block header misaligns records");
+				const size_t bytes = size > BlockSize ? size : BlockSize;
+				Block* block = static_cast<Block*>(::operator new(sizeof(Block) + bytes));
+				block->next = m_Head;
+				block->size = bytes;
+				block->used = size;
+				m_Head = block;
+				return block + 1;
+			}
+
+			//! \brief Constructs a record in the arena.
+			template <typename Record, typename... Args> Record* Create(Args&&... args) { return new (Allocate(sizeof(Record), std::alignment_of<Record>::value)) Record(std::forward<Args>(args)...); }
+
+			//! \brief Frees all blocks.  Records must already have been destructed.
+			void Release()
+			{
+				while (Block* block = m_Head)
+				{
+					m_Head = block->next;
+					::operator delete(block);
+				}
+			}
+		};
+
+		//! \brief Allocates memory aligned to a power of two, e.g. for over-aligned SIMD types.  The start of the heap block is
+		//! stored just before the returned memory; release it with aligned_delete.
+		inline void* aligned_new(size_t size, size_t alignment)
+		{
+			if (alignment < sizeof(void*))
+				alignment = sizeof(void*);
+			char* block = static_cast<char*>(::operator new(size + alignment + sizeof(void*)));
+			char* data = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(block) + sizeof(void*) + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+			reinterpret_cast<void**>(data)[-1] = block;
+			return data;
+		}
+
+		//! \brief Releases memory from aligned_new.
+		inline void aligned_delete(void* ptr)
+		{
+			if (ptr != nullptr)
+				::operator delete(static_cast<void**>(ptr)[-1]);
+		}
+
+		//! \brief Per-thread cache of blocks for values too large or too aligned to be stored inline in an Any.
+		//! Blocks are kept in power-of-two size classes and recycled rather than returned to the heap.
+		class AnyPool
+		{
+			static const size_t MinShift = 5; //!< The smallest class holds 32 bytes.
+			static const size_t ClassCount = 6; //!< The largest class holds 1024 bytes; larger values go straight to the heap.
+
+		public:
+			static const size_t Alignment = 32; //!< Alignment of every block, enough for AVX vectors and matrices.
+			static const size_t MaxCached = 64; //!< Blocks kept per size class; any more are returned to the heap.
+
+		private:
+
+			struct Block { Block* next; };
+			Block* m_Free[ClassCount]; //!< Free list per size class.
+			size_t m_Count[ClassCount]; //!< Number of blocks on each free list.
+
+			static size_t SizeClass(size_t size)
+			{
+				size_t c = 0;
+				while ((size_t(1) << (c + MinShift)) < size)
+					++c;
+				return c;
+			}
+
+			//! \brief Set once the calling thread's pool has been destroyed.
+			//! Kept apart from the pool and trivially destructible, so it can still be read while other thread locals are torn down.
+			static bool& Closed() { static thread_local bool s_Closed = false; return s_Closed; }
+
+			//! \brief Retrieves the pool for the calling thread.  Must not be called once Closed is set.
+			static AnyPool& Local() { static thread_local AnyPool s_Pool; return s_Pool; }
+
+		public:
+			AnyPool() : m_Free(), m_Count() { }
+
+			//! \brief Releases the cached blocks when the owning thread exits.
+			~AnyPool()
+			{
+				Release();
+				Closed() = true;
+			}
+
+			//! \brief Allocates a block of at least size bytes, aligned to Alignment, from the calling thread's pool.
+			static void* Allocate(size_t size)
+			{
+				const size_t c = SizeClass(size);
+				if (c >= ClassCount)
+					return aligned_new(size, Alignment);
+
+				if (!Closed())
+				{
+					AnyPool& pool = Local();
+					if (Block* b = pool.m_Free[c])
+					{
+						pool.m_Free[c] = b->next;
+						--pool.m_Count[c];
+						return b;
+					}
+				}
+				return aligned_new(size_t(1) << (c + MinShift), Alignment);
+			}
+
+			//! \brief Returns a block from Allocate to the calling thread's pool.  May be called from any thread.
+			static void Free(void* ptr, size_t size)
+			{
+				const size_t c = SizeClass(size);
+				if (c >= ClassCount || Closed())
+				{
+					aligned_delete(ptr);
+					return;
+				}
+
+				AnyPool& pool = Local();
+				if (pool.m_Count[c] == MaxCached)
+				{
+					aligned_delete(ptr);
+					return;
+				}
+
+				Block* b = static_cast<Block*>(ptr);
+				b->next = pool.m_Free[c];
+				pool.m_Free[c] = b;
+				++pool.m_Count[c];
+			}
+
+			//! \brief Retrieves the number of blocks cached by the calling thread for values of a size.
+			static size_t GetCached(size_t size)
+			{
+				const size_t c = SizeClass(size);
+				return c < ClassCount && !Closed() ? Local().m_Count[c] : 0;
+			}
+
+			//! \brief Releases the blocks cached by the calling thread to the heap.  Done automatically when the thread exits.
+			static void Trim()
+			{
+				if (!Closed())
+					Local().Release();
+			}
+
+		private:
+			//! \brief Releases the cached blocks of this pool to the heap.
+			void Release()
+			{
+				for (size_t c = 0; c != ClassCount; ++c)
+				{
+					while (Block* b = m_Free[c])
+					{
+						m_Free[c] = b->next;
+						aligned_delete(b);
+					}
+					m_Count[c] = 0;
+				}
+			}
+		};
+
+		//! \brief Checks if a value of a type is stored inline in an Any.
+		template <typename Type> struct any_is_inline
+		{
+			static const bool value = sizeof(Type) <= META_ANY_INLINE_SIZE && std::alignment_of<Type>::value <= META_ANY_ALIGNMENT;
+		};
+
+		//! \brief Checks if a type can be moved to a new address by copying its bytes and forgetting the original.
+		//! Specialize as std::true_type for types that are not trivially copyable but can still be relocated this way.
+		template <typename Type> struct is_trivially_relocatable : std::is_trivially_copyable<Type> { };
+
+		//! \brief Knows how to construct, copy, relocate and destruct a value stored inline in an Any.
+		template <typename Type, bool Inline = any_is_inline<Type>::value> struct any_value
+		{
+			static void construct(void* storage, const Type& obj) { new (storage) Type(obj); }
+			static void destruct(void* storage) { static_cast<Type*>(storage)->~Type(); }
+			static void relocate(void* dst, void* src) { new (dst) Type(std::move(*static_cast<Type*>(src))); static_cast<Type*>(src)->~Type(); }
+			static void copy(void* dst, const void* src) { new (dst) Type(*static_cast<const Type*>(src)); }
+
+			// null functions mean the Any handles the operation by copying its storage bytes, or does nothing
+			static void (*destructor())(void*) { return std::is_trivially_destructible<Type>::value ? nullptr : &destruct; }
+			static void (*mover())(void*, void*) { return is_trivially_relocatable<Type>::value ? nullptr : &relocate; }
+			static void (*copier())(void*, const void*) { return std::is_trivially_copyable<Type>::value ? nullptr : &copy; }
+		};
+
+		//! \brief Knows how to construct, copy and destruct a value stored in a pooled block referenced by an Any.
+		//! Relocating only moves the block pointer, so it is always done by copying the Any's storage bytes.
+		template <typename Type> struct any_value<Type, false>
+		{
+			static_assert(std::alignment_of<Type>::value <= AnyPool::Alignment, "type is too aligned to be stored in an Any");
+
+			static void construct(void* storage, const Type& obj) { *static_cast<void**>(storage) = new (AnyPool::Allocate(sizeof(Type))) Type(obj); }
+			static void destruct(void* storage) { Type* obj = *static_cast<Type**>(storage); obj->~Type(); AnyPool::Free(obj, sizeof(Type)); }
+			static void copy(void* dst, const void* src) { construct(dst, **static_cast<Type* const*>(src)); }
+
+			static void (*destructor())(void*) { return &destruct; }
+			static void (*mover())(void*, void*) { return nullptr; }
+			static void (*copier())(void*, const void*) { return &copy; }
+		};
+
+		//! \brief Default constructs and destructs objects of a type in place for TypeInfo.
+		template <typename Type, bool Constructible = std::is_default_constructible<Type>::value> struct type_lifecycle
 		{
+			static void construct(void* obj) { new (obj) Type(); }
 			static void destruct(void* obj) { static_cast<Type*>(obj)->~Type(); }
+
+			static void (*constructor())(void*) { return &construct; }
+			static void (*destructor())(void*) { return &destruct; }
+		};
+
+		//! \brief Lifecycle for types that cannot be default constructed, such as abstract types.
+		template <typename Type> struct type_lifecycle<Type, false>
+		{
+			static void destruct(void* obj) { static_cast<Type*>(obj)->~Type(); }
+
+			static void (*constructor())(void*) { return nullptr; }
+			static void (*destructor())(void*) { return &destruct; }
+		};
+
+		//! \brief Moves an object of a type into uninitialized storage and destructs the source, for TypeInfo.
+		template <typename Type, bool Movable = std::is_move_constructible<Type>::value> struct type_relocate
+		{
+			static void relocate(void* dst, void* src) { new (dst) Type(std::move(*static_cast<Type*>(src))); static_cast<Type*>(src)->~Type(); }
+
+			static void (*relocator())(void*, void*) { return &relocate; }
+		};
+
+		//! \brief Relocation for types that cannot be moved.
+		template <typename Type> struct type_relocate<Type, false> { static void (*relocator())(void*, void*) { return nullptr; } };
+
+		//! \brief Copy assigns objects of a type, for TypeInfo.
+		template <typename Type, bool Assignable = std::is_copy_assignable<Type>::value> struct type_assign
+		{
+			static void assign(void* dst, const void* src) { *static_cast<Type*>(dst) = *static_cast<const Type*>(src); }
+
+			static void (*assigner())(void*, const void*) { return &assign; }
 		};
 
-		//! \brief Knows how to move a non-const type.
-		template <typename Type> struct mover
+		//! \brief Assignment for types that cannot be copy assigned.
+		template <typename Type> struct type_assign<Type, false> { static void (*assigner())(void*, const void*) { return nullptr; } };
+
+		//! \brief Plans compiled on first use and shared between threads, for the Serializer, Hasher and Migrator.
+		//! Plans are never removed, so references to them stay valid. Each thread remembers the plan it used last and
+		//! only takes the lock when it asks for a different one.
+		template <typename Map> class plan_cache
 		{
-			static void move(void* dst, void* src) { new (dst) Type(std::move(*static_cast<Type*>(src))); }
+			Map m_Plans; //!< Compiled plans by key.
+			std::mutex m_Mutex; //!< Guards m_Plans and whatever the owner compiles them from.
+
+		public:
+			typedef typename Map::key_type Key;
+			typedef typename Map::mapped_type Plan;
+
+			//! \brief Locks the cache, e.g. while changing the settings plans are compiled from.
+			std::unique_lock<std::mutex> Lock() { return std::unique_lock<std::mutex>(m_Mutex); }
+
+			//! \brief Retrieves the plan for a key, calling compile() under the lock to build it on first use.
+			template <typename Compile> const Plan& Get(const Key& key, Compile compile)
+			{
+				struct Last { const plan_cache* cache; Key key; const Plan* plan; };
+				static thread_local Last s_Last = { nullptr, Key(), nullptr };
+				if (s_Last.cache == this && s_Last.key == key)
+					return *s_Last.plan;
+
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				auto p = m_Plans.find(key);
+				if (p == m_Plans.end())
+					p = m_Plans.emplace(key, compile()).first;
+				s_Last.cache = this;
+				s_Last.key = key;
+				s_Last.plan = &p->second;
+				return p->second;
+			}
 		};
 
-		//! \brief Knows how to copy a type.
-		template <typename Type> struct mover<const Type*>
+		//! \brief Threads kept for Method::CallBatch.  They are started the first time a batch needs them and reused by
+		//! later batches, which then pay for waking a thread rather than for creating and joining one.
+		class batch_workers
 		{
-			static void move(void* dst, void* src) { new (dst) Type(*static_cast<Type*>(src)); }
+			struct Batch { size_t remaining; };
+			struct Job { void (*run)(void* function, size_t index); void* function; size_t index; Batch* batch; };
+
+			std::vector<std::thread> m_Threads; //!< The workers, as many as the largest batch has needed.
+			std::deque<Job> m_Jobs; //!< Jobs waiting for a thread.
+			std::mutex m_Mutex; //!< Guards everything else.
+			std::condition_variable m_Wake; //!< Signalled when jobs are queued or the workers must stop.
+			std::condition_variable m_Done; //!< Signalled when a batch completes.
+			bool m_Stop; //!< Set when the workers must exit.
+
+			batch_workers() : m_Stop(false) { }
+			batch_workers(const batch_workers&); // = delete
+			void operator=(const batch_workers&); // = delete
+
+			~batch_workers()
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					m_Stop = true;
+				}
+				m_Wake.notify_all();
+				for (auto& t : m_Threads)
+					t.join();
+			}
+
+			//! \brief Runs the first queued job with the lock released.
+			void RunFront(std::unique_lock<std::mutex>& lock)
+			{
+				Job job = m_Jobs.front();
+				m_Jobs.pop_front();
+				lock.unlock();
+				job.run(job.function, job.index);
+				lock.lock();
+				if (--job.batch->remaining == 0)
+					m_Done.notify_all();
+			}
+
+			void Work()
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				for (;;)
+				{
+					m_Wake.wait(lock, [this] { return m_Stop || !m_Jobs.empty(); });
+					if (m_Jobs.empty())
+						return;
+					RunFront(lock);
+				}
+			}
+
+		public:
+			//! \brief Retrieves the workers.
+			static batch_workers& Instance() { static batch_workers s_Workers; return s_Workers; }
+
+			//! \brief Retrieves the most threads a batch is split across, including the calling thread: one per hardware
+			//! thread, or 4 if that number is unknown.  This also bounds how many workers are ever started.
+			static unsigned GetMaxThreads()
+			{
+				static const unsigned s_Max = std::thread::hardware_concurrency() != 0 ? std::thread::hardware_concurrency() : 4;
+				return s_Max;
+			}
+
+			//! \brief Calls function(index) for every index below count, the last on the calling thread and the others on
+			//! workers, and returns once all calls have.
+			template <typename Function> void Run(size_t count, Function& function)
+			{
+				void (*run)(void*, size_t) = [](void* f, size_t index) { (*static_cast<Function*>(f))(index); };
+				Batch batch = { count - 1 };
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					while (m_Threads.size() < count - 1)
+						m_Threads.push_back(std::thread([this] { Work(); }));
+					for (size_t i = 0; i + 1 < count; ++i)
+					{
+						Job job = { run, &function, i, &batch };
+						m_Jobs.push_back(job);
+					}
+				}
+				m_Wake.notify_all();
+				function(count - 1);
+
+				// queued jobs are run here while waiting, so a batch started from inside a job cannot wait on itself
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				while (batch.remaining != 0)
+				{
+					if (!m_Jobs.empty())
+						RunFront(lock);
+					else
+						m_Done.wait(lock);
+				}
+			}
 		};
 	}
 
@@ -146,62 +669,416 @@ namespace Meta
 		template <> struct make_type_record<void> { static const TypeRecord type() { return TypeRecord(nullptr, TypeRecord::Void); } };
 
 		template <typename Type> struct make_any;
+
+		//! \brief Provides a unique identity for a method signature, used to validate typed invocations.
+		template <typename ReturnType, typename... ParamTypes> struct signature
+		{
+			static const void* id() { static char s_Id; return &s_Id; } // not const, so identical constants cannot be folded together
+		};
 	}
 
+#if META_PROFILE
+	//! \brief Counts reflected lookups, accesses, calls and Any constructions by type and name, when built with META_PROFILE.
+	//! Every event is counted; one in SampleInterval events per thread is also timed. Counters refer to TypeInfos, so
+	//! they must be dumped before Registry::Clear.
+	class Profiler
+	{
+	public:
+		//! \brief The kinds of event counted.  Each *Miss enumerator directly follows its *Hit, so Miss == Hit + 1; Scope::Miss relies on this order.
+		enum Event
+		{
+			FindMemberHit, //!< TypeInfo::FindMember found the name
+			FindMemberMiss, //!< TypeInfo::FindMember did not find the name
+			FindMethodHit, //!< TypeInfo::FindMethod found the name
+			FindMethodMiss, //!< TypeInfo::FindMethod did not find the name
+			MemberGet, //!< Member::Get
+			MemberSet, //!< Member::Set
+			MethodCall, //!< Method::Call
+			AnyConstruct, //!< An Any boxing or copying a value
+			EventCount
+		};
+
+		//! \brief The totals for one event of one type and name.
+		struct Counter
+		{
+			unsigned long long count; //!< Number of events.
+			unsigned long long samples; //!< Number of events timed.
+			unsigned long long nanoseconds; //!< Total time of the timed events.
+			unsigned long long maxNanoseconds; //!< Longest timed event.
+		};
+
+		static const unsigned SampleInterval = 16; //!< One in this many events per thread is timed.
+
+		//! \brief Counts an event when destroyed, timing it if it is sampled.  Use through META_PROFILE_SCOPE.
+		class Scope
+		{
+			Event m_Event;
+			const TypeInfo* m_Type;
+			const char* m_Name;
+			bool m_Sampled;
+			std::chrono::steady_clock::time_point m_Start;
+
+			Scope(const Scope&); // = delete
+			void operator=(const Scope&); // = delete
+
+		public:
+			Scope(Event event, const TypeInfo* type, const char* name) : m_Event(event), m_Type(type), m_Name(name)
+			{
+				static thread_local unsigned s_Tick = 0;
+				m_Sampled = ++s_Tick % SampleInterval == 0;
+				if (m_Sampled)
+					m_Start = std::chrono::steady_clock::now();
+			}
+
+			~Scope()
+			{
+				const unsigned long long elapsed = m_Sampled ? static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_Start).count()) : 0;
+				Instance().Record(m_Event, m_Type, m_Name, elapsed, m_Sampled);
+			}
+
+			//! \brief Records the miss event paired with a lookup hit instead.
+			void Miss() { m_Event = static_cast<Event>(m_Event + 1); }
+		};
+
+	private:
+		typedef std::tuple<const TypeInfo*, std::string, Event> Key;
+
+		//! \brief The totals of one event of one type and name pointer on one thread.  Only that thread writes them, so
+		//! they are bumped with relaxed loads and stores that compile to plain moves, while Each may read them meanwhile.
+		struct Slot
+		{
+			const TypeInfo* type; //!< The type.
+			const char* key; //!< The name pointer as recorded, which identifies the slot along with type and event.
+			std::string name; //!< A copy of the name, for Each to merge and report after the recorded pointer is gone.
+			Event event; //!< The event.
+			std::atomic<unsigned long long> count; //!< See Counter.
+			std::atomic<unsigned long long> samples; //!< See Counter.
+			std::atomic<unsigned long long> nanoseconds; //!< See Counter.
+			std::atomic<unsigned long long> maxNanoseconds; //!< See Counter.
+		};
+
+		//! \brief A fixed run of slots.  Blocks never move, so Each can read them while their thread adds more.
+		struct Block
+		{
+			static const size_t Size = 64; //!< Slots per block.
+
+			Slot slots[Size]; //!< The slots, of which the first used are published.
+			std::atomic<size_t> used; //!< Published slots.
+			std::atomic<Block*> next; //!< The next block, or nullptr.
+
+			Block() : used(0), next(nullptr) { }
+		};
+
+		//! \brief The counters of one thread, found through a private hash table on the type, name pointer and event.
+		class Local
+		{
+			Block* m_First; //!< The first block.
+			Block* m_Last; //!< The block new slots go in.
+			std::vector<Slot*> m_Index; //!< Open-addressed table of slots, only used by the owning thread.
+			size_t m_Count; //!< Slots in use.
+			std::atomic<unsigned> m_Epoch; //!< The Reset the counters were last cleared by.
+
+			Local(const Local&); // = delete
+			void operator=(const Local&); // = delete
+
+			static size_t Hash(const TypeInfo* type, const char* name, Event event)
+			{
+				size_t h = reinterpret_cast<size_t>(type) ^ (reinterpret_cast<size_t>(name) * 31) ^ (static_cast<size_t>(event) << 4);
+				return (h ^ (h >> 15)) * 2654435761u;
+			}
+
+			static void Bump(std::atomic<unsigned long long>& value, unsigned long long by) { value.store(value.load(std::memory_order_relaxed) + by, std::memory_order_relaxed); }
+
+			void Insert(Slot* slot)
+			{
+				const size_t mask = m_Index.size() - 1;
+				size_t i = Hash(slot->type, slot->key, slot->event) & mask;
+				while (m_Index[i] != nullptr)
+					i = (i + 1) & mask;
+				m_Index[i] = slot;
+			}
+
+			//! \brief Adds and publishes a slot.
+			Slot* Add(Event event, const TypeInfo* type, const char* name)
+			{
+				if ((m_Count + 1) * 2 > m_Index.size())
+				{
+					m_Index.assign(m_Index.size() * 2, nullptr);
+					for (Block* b = m_First; b != nullptr; b = b->next.load(std::memory_order_relaxed))
+						for (size_t i = 0, used = b->used.load(std::memory_order_relaxed); i != used; ++i)
+							Insert(&b->slots[i]);
+				}
+
+				size_t used = m_Last->used.load(std::memory_order_relaxed);
+				if (used == Block::Size)
+				{
+					Block* block = new Block;
+					m_Last->next.store(block, std::memory_order_release);
+					m_Last = block;
+					used = 0;
+				}
+
+				Slot* slot = &m_Last->slots[used];
+				slot->type = type;
+				slot->key = name;
+				slot->name = name != nullptr ? name : "";
+				slot->event = event;
+				slot->count.store(0, std::memory_order_relaxed);
+				slot->samples.store(0, std::memory_order_relaxed);
+				slot->nanoseconds.store(0, std::memory_order_relaxed);
+				slot->maxNanoseconds.store(0, std::memory_order_relaxed);
+				m_Last->used.store(used + 1, std::memory_order_release);
+
+				Insert(slot);
+				++m_Count;
+				return slot;
+			}
+
+		public:
+			Local() : m_First(new Block), m_Last(m_First), m_Index(64, nullptr), m_Count(0), m_Epoch(Instance().m_Epoch.load())
+			{
+				std::lock_guard<std::mutex> lock(Instance().m_Mutex);
+				Instance().m_Threads.push_back(this);
+			}
+
+			//! \brief Hands the counters over to the profiler when the owning thread exits.
+			~Local()
+			{
+				Profiler& profiler = Instance();
+				{
+					std::lock_guard<std::mutex> lock(profiler.m_Mutex);
+					MergeInto(profiler.m_Retired, profiler.m_Epoch.load());
+					profiler.m_Threads.erase(std::find(profiler.m_Threads.begin(), profiler.m_Threads.end(), this));
+				}
+				for (Block* b = m_First; b != nullptr; )
+				{
+					Block* next = b->next.load(std::memory_order_relaxed);
+					delete b;
+					b = next;
+				}
+			}
+
+			//! \brief Counts an event.  Called only by the owning thread.
+			void Record(Event event, const TypeInfo* type, const char* name, unsigned long long nanoseconds, bool sampled, unsigned epoch)
+			{
+				if (m_Epoch.load(std::memory_order_relaxed) != epoch)
+				{
+					for (Block* b = m_First; b != nullptr; b = b->next.load(std::memory_order_relaxed))
+					{
+						for (size_t i = 0, used = b->used.load(std::memory_order_relaxed); i != used; ++i)
+						{
+							b->slots[i].count.store(0, std::memory_order_relaxed);
+							b->slots[i].samples.store(0, std::memory_order_relaxed);
+							b->slots[i].nanoseconds.store(0, std::memory_order_relaxed);
+							b->slots[i].maxNanoseconds.store(0, std::memory_order_relaxed);
+						}
+					}
+					m_Epoch.store(epoch, std::memory_order_release);
+				}
+
+				Slot* slot = nullptr;
+				const size_t mask = m_Index.size() - 1;
+				for (size_t i = Hash(type, name, event) & mask; m_Index[i] != nullptr; i = (i + 1) & mask)
+				{
+					Slot* s = m_Index[i];
+					if (s->key == name && s->type == type && s->event == event)
+					{
+						slot = s;
+						break;
+					}
+				}
+				if (slot == nullptr)
+					slot = Add(event, type, name);
+
+				Bump(slot->count, 1);
+				if (sampled)
+				{
+					Bump(slot->samples, 1);
+					Bump(slot->nanoseconds, nanoseconds);
+					if (nanoseconds > slot->maxNanoseconds.load(std::memory_order_relaxed))
+						slot->maxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+				}
+			}
+
+			//! \brief Adds the counters to totals by type, name and event, unless they predate the given Reset.
+			void MergeInto(std::map<Key, Counter>& totals, unsigned epoch) const
+			{
+				if (m_Epoch.load(std::memory_order_acquire) != epoch)
+					return;
+
+				for (const Block* b = m_First; b != nullptr; b = b->next.load(std::memory_order_acquire))
+				{
+					for (size_t i = 0, used = b->used.load(std::memory_order_acquire); i != used; ++i)
+					{
+						const Slot& s = b->slots[i];
+						const unsigned long long count = s.count.load(std::memory_order_relaxed);
+						if (count == 0)
+							continue;
+
+						Counter& c = totals[Key(s.type, s.name, s.event)];
+						c.count += count;
+						c.samples += s.samples.load(std::memory_order_relaxed);
+						c.nanoseconds += s.nanoseconds.load(std::memory_order_relaxed);
+						c.maxNanoseconds = std::max(c.maxNanoseconds, s.maxNanoseconds.load(std::memory_order_relaxed));
+					}
+				}
+			}
+		};
+
+		mutable std::mutex m_Mutex; //!< Guards m_Threads and m_Retired.
+		std::vector<Local*> m_Threads; //!< The counters of running threads that have recorded an event.
+		std::map<Key, Counter> m_Retired; //!< The counters of threads that have exited.
+		std::atomic<unsigned> m_Epoch; //!< Advanced by Reset; counters from an earlier epoch are stale.
+
+		Profiler() : m_Epoch(0) { }
+		Profiler(const Profiler&); // = delete
+		void operator=(const Profiler&); // = delete
+
+	public:
+		//! \brief Retrieves the profiler.
+		static Profiler& Instance() { static Profiler s_Profiler; return s_Profiler; }
+
+		//! \brief Retrieves the name of an event.
+		static const char* GetEventName(Event event)
+		{
+			static const char* const s_Names[EventCount] = { "find member hit", "find member miss", "find method hit", "find method miss", "member get", "member set", "method call", "any construct" };
+			return s_Names[event];
+		}
+
+		//! \brief Adds an event to the calling thread's counters, without locking or allocating once the thread has seen the
+		//! same type, name pointer and event before.
+		//! \param name The member or method name, or nullptr.  Counters are keyed by the pointer and merged by text in Each.
+		void Record(Event event, const TypeInfo* type, const char* name, unsigned long long nanoseconds, bool sampled)
+		{
+			static thread_local Local s_Local;
+			s_Local.Record(event, type, name, nanoseconds, sampled, m_Epoch.load(std::memory_order_relaxed));
+		}
+
+		//! \brief Calls fn(const TypeInfo* type, const char* name, Event event, const Counter& counter) for each counter, ordered
+		//! by type.  The counters of every thread, running or exited, are merged first.
+		template <typename Function> void Each(Function fn) const
+		{
+			std::map<Key, Counter> totals;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				totals = m_Retired;
+				const unsigned epoch = m_Epoch.load();
+				for (auto t : m_Threads)
+					t->MergeInto(totals, epoch);
+			}
+			for (auto& c : totals)
+				fn(std::get<0>(c.first), std::get<1>(c.first).c_str(), std::get<2>(c.first), c.second);
+		}
+
+		//! \brief Writes one line per counter: type, name, event, count and the mean and longest sampled time.
+		inline void Dump(std::ostream& out) const;
+
+		//! \brief Discards all counters.  Each thread clears its own the next time it records an event; until then they are ignored.
+		void Reset()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Retired.clear();
+			++m_Epoch;
+		}
+	};
+#endif
+
 	//! \brief Holds any type of value that can be handled by the introspection system
 	class Any
 	{
 	private:
 		union
 		{
-			double _align_me; //!< force allignment
-			char m_Data[4 * sizeof(float)]; //!< large enough for 4 floats, e.g. a vec4
-			void* m_Ptr; //!< convenien
+			alignas(META_ANY_ALIGNMENT) char m_Data[META_ANY_INLINE_SIZE]; //!< inline storage, by default large enough for 4 floats, e.g. a vec4
+			void* m_Ptr; //!< the referenced object, or the pooled block holding a large value
 		};
+		static_assert(META_ANY_INLINE_SIZE >= sizeof(void*), "META_ANY_INLINE_SIZE must hold a pointer, as moves and copies copy m_Data whole");
 		TypeRecord m_TypeRecord; //!< Type record information stored in this Any
 		typedef void (*Destructor)(void*); //!< Type of the destructor function
-		typedef void (*Mover)(void*, void*); //!< Type of the mover function
-		Destructor m_Destructor; //!< Destructor for the bound type
-		Mover m_Mover; //!< Mover for the bound type
-
-		//! \brief Deleted copy constructor
-		Any(const Any&); // = delete
-		//! \brief Deleted copy assignment
-		void operator=(const Any&); // = delete
+		typedef void (*Mover)(void*, void*); //!< Type of the mover function, which leaves the source destructed
+		typedef void (*Copier)(void*, const void*); //!< Type of the copier function
+		Destructor m_Destructor; //!< Destructor for the bound type, or nullptr if trivially destructible
+		Mover m_Mover; //!< Mover for the bound type, or nullptr if relocated by copying m_Data
+		Copier m_Copier; //!< Copier for the bound type, or nullptr if copied by copying m_Data
+		bool m_Pooled; //!< True if a by-value value lives in the pooled block at m_Ptr
+
+		//! \brief Destroys the held value, if any, and leaves this Any empty.
+		void Reset()
+		{
+			if (m_Destructor != nullptr)
+				m_Destructor(m_Data);
+			m_TypeRecord = TypeRecord();
+			m_Destructor = nullptr;
+			m_Mover = nullptr;
+			m_Copier = nullptr;
+			m_Pooled = false;
+		}
 
 	public:
 		//! \brief Constructs an Any that holds nothing
-		Any() : m_Ptr(nullptr), m_Destructor(nullptr), m_Mover(nullptr) { }
+		Any() : m_Ptr(nullptr), m_Destructor(nullptr), m_Mover(nullptr), m_Copier(nullptr), m_Pooled(false) { }
 
 		//! \brief Moves one Any into another
-		Any(Any&& src) : m_Destructor(nullptr) { *this = std::move(src); }
+		Any(Any&& src) noexcept : m_Destructor(nullptr) { *this = std::move(src); }
 
-		//! \brief Moves one Any into another
-		Any& operator=(Any&& src)
+		//! \brief Copies one Any into another
+		Any(const Any& src) : m_Destructor(nullptr) { *this = src; META_PROFILE_COUNT(AnyConstruct, GetType(), nullptr); }
+
+		//! \brief Moves one Any into another, leaving the source empty
+		Any& operator=(Any&& src) noexcept
 		{
 			if (this != &src)
 			{
 				if (m_Destructor != nullptr)
 					m_Destructor(m_Data);
-				m_Mover = src.m_Mover;
+				m_TypeRecord = src.m_TypeRecord;
 				m_Destructor = src.m_Destructor;
-				m_Mover(m_Data, src.m_Data);
-				if (m_Destructor != nullptr)
-					m_Destructor(src.m_Data);
+				m_Mover = src.m_Mover;
+				m_Copier = src.m_Copier;
+				m_Pooled = src.m_Pooled;
+				if (m_Mover != nullptr)
+					m_Mover(m_Data, src.m_Data);
+				else
+					std::memcpy(m_Data, src.m_Data, sizeof(m_Data));
 				src.m_Destructor = nullptr;
-				src.m_Mover = nullptr;
+				src.Reset();
+			}
+			return *this;
+		}
+
+		//! \brief Copies one Any into another
+		Any& operator=(const Any& src)
+		{
+			if (this != &src)
+			{
+				Reset();
+				if (src.m_Copier != nullptr)
+					src.m_Copier(m_Data, src.m_Data);
+				else
+					std::memcpy(m_Data, src.m_Data, sizeof(m_Data));
+				m_TypeRecord = src.m_TypeRecord;
+				m_Destructor = src.m_Destructor;
+				m_Mover = src.m_Mover;
+				m_Copier = src.m_Copier;
+				m_Pooled = src.m_Pooled;
 			}
 			return *this;
 		}
 
-		//! \brief Constucts an Any that contains an object
-		template <typename Type> Any(const Type& obj) : m_TypeRecord(internal::make_type_record<Type>::type()), m_Destructor(&internal::destructor<Type>::destruct), m_Mover(&internal::mover<Type>::move) { static_assert(sizeof(Type) <= sizeof(m_Data), "Type is too large"); new (m_Data) Type(obj); }
+		//! \brief Constucts an Any that contains an object, inline if it fits and in a pooled block otherwise
+		template <typename Type> Any(const Type& obj) : m_TypeRecord(internal::make_type_record<Type>::type()), m_Destructor(internal::any_value<Type>::destructor()), m_Mover(internal::any_value<Type>::mover()), m_Copier(internal::any_value<Type>::copier()), m_Pooled(!internal::any_is_inline<Type>::value) { internal::any_value<Type>::construct(m_Data, obj); META_PROFILE_COUNT(AnyConstruct, GetType(), nullptr); }
 
 		//! \brief Constucts an Any that points at a non-const object
-		template <typename Type> Any(Type* obj) : m_Ptr(obj), m_TypeRecord(internal::make_type_record<Type*>::type()), m_Destructor(nullptr), m_Mover(&internal::mover<Type*>::move) { }
+		template <typename Type> Any(Type* obj) : m_Ptr(obj), m_TypeRecord(internal::make_type_record<Type*>::type()), m_Destructor(nullptr), m_Mover(nullptr), m_Copier(nullptr), m_Pooled(false) { }
 
 		//! \brief Constucts an Any that points at a const object
-		template <typename Type> Any(const Type* obj) : m_Ptr(const_cast<Type*>(obj)), m_TypeRecord(internal::make_type_record<const Type*>::type()), m_Destructor(nullptr), m_Mover(&internal::mover<const Type*>::move) { }
+		template <typename Type> Any(const Type* obj) : m_Ptr(const_cast<Type*>(obj)), m_TypeRecord(internal::make_type_record<const Type*>::type()), m_Destructor(nullptr), m_Mover(nullptr), m_Copier(nullptr), m_Pooled(false) { }
+
+		//! \brief Constucts an Any that points at a non-const object whose type is only known at runtime
+		Any(void* obj, const TypeInfo* type) : m_Ptr(obj), m_TypeRecord(type, TypeRecord::Pointer), m_Destructor(nullptr), m_Mover(nullptr), m_Copier(nullptr), m_Pooled(false) { }
+
+		//! \brief Constucts an Any that points at a const object whose type is only known at runtime
+		Any(const void* obj, const TypeInfo* type) : m_Ptr(const_cast<void*>(obj)), m_TypeRecord(type, TypeRecord::ConstPointer), m_Destructor(nullptr), m_Mover(nullptr), m_Copier(nullptr), m_Pooled(false) { }
 
 		//! \brief Cleans up the value stored in the Any if necessary
 		~Any()
@@ -224,7 +1101,7 @@ namespace Meta
 		{
 			switch (m_TypeRecord.qualifier)
 			{
-			case TypeRecord::Value: return const_cast<char*>(m_Data);
+			case TypeRecord::Value: return m_Pooled ? m_Ptr : const_cast<char*>(m_Data);
 			case TypeRecord::Pointer:
 			case TypeRecord::ConstPointer:
 				return m_Ptr;
@@ -246,7 +1123,7 @@ namespace Meta
 
 	namespace internal
 	{
-		template <typename Type> struct make_any { static Any make(Type value) { return Any(value); } };
+		template <typename Type> struct make_any { static Any make(const Type& value) { return Any(value); } }; // by reference, as over-aligned values cannot be passed by value on every target
 		template <typename Type> struct make_any<Type&> { static Any make(Type& value) { return Any(&value); } };
 	}
 
@@ -256,12 +1133,14 @@ namespace Meta
 		const char* m_Name; //!< The name of this variable.
 		const TypeInfo* m_Owner; //!< The type this member variable belongs to.
 		const TypeInfo* m_Type; //!< The type of this member variable.
+		ptrdiff_t m_Offset; //!< Offset of the variable within the owner, or -1 if it is accessed through functions.
 
 	protected:
 		//! \brief Constructor for a member variable.
 		//! \param name The name of the member.
 		//! \parm type The type of the member.
-		Member(const char* name, const TypeInfo* type) : m_Name(name), m_Type(type) { }
+		//! \param offset The offset of the variable within the owner, or -1 if it is not stored directly.
+		Member(const char* name, const TypeInfo* type, ptrdiff_t offset = -1) : m_Name(name), m_Type(type), m_Offset(offset) { }
 		virtual ~Member() { }
 
 		//! \brief Reimplement to get the value of a member variable.
@@ -290,6 +1169,12 @@ namespace Meta
 		//! \brief Retrieves the owner of the member variable.
 		const TypeInfo* GetOwner() const { return m_Owner; }
 
+		//! \brief Checks if the variable is stored directly in the owner rather than accessed through functions.
+		bool IsField() const { return m_Offset >= 0; }
+
+		//! \brief Retrieves the offset of the variable within the owner, or -1 if it is not a field.
+		ptrdiff_t GetOffset() const { return m_Offset; }
+
 		//! \brief Tests if the variable value can be retrieved into the given output any ref.
 		//! \param obj An instance of the owner type.
 		//! \returns True if Get is safe to call with these arguments, false otherwise.
@@ -334,6 +1219,8 @@ namespace Meta
 	{
 		const char* m_Name; //!< The name of the method.
 		const TypeInfo* m_Owner; //!< The type that owns the method.
+		const void* m_Signature; //!< Identity of the exact return and parameter types, from internal::signature.
+		void (*m_Invoker)(); //!< Typed thunk that calls the method directly, cast back to its real type by Invoke.
 
 		//! \brief Sets the owner type.  Only to be called by TypeInfo.
 		void SetOwner(const TypeInfo* m_Type) { m_Owner = m_Type; }
@@ -341,7 +1228,9 @@ namespace Meta
 	protected:
 		//! \brief Constuctor for the method.
 		//! \param The name of the method.
-		Method(const char* name) : m_Name(name) { }
+		//! \param signature The identity of the method's signature from internal::signature.
+		//! \param invoker A function of type ReturnType (*)(const Method*, void*, ParamTypes...) that calls the method.
+		Method(const char* name, const void* signature, void (*invoker)()) : m_Name(name), m_Signature(signature), m_Invoker(invoker) { }
 		virtual ~Method() { }
 
 		//! \brief Override to implement calling the method.
@@ -352,6 +1241,33 @@ namespace Meta
 		//! \returns The return value as an Any
 		virtual Any DoCall(const Any& obj, int argc, const Any* argv) const = 0;
 
+		//! \brief Override to implement calling the method on many objects, once CallBatch has validated the call.
+		//! \param first The first object, already adjusted to the owner type.
+		//! \param count The number of objects.
+		//! \param stride The distance in bytes from one object to the next.
+		//! \param argv The arguments of the first call.
+		//! \param argvStride The distance in Anys between the arguments of consecutive calls, or 0 if they are shared.
+		//! \param results Receives the return values, or nullptr.
+		virtual void DoCallBatch(char* first, size_t count, size_t stride, const Any* argv, size_t argvStride, Any* results) const = 0;
+
+		//! \brief Checks that arguments match the parameter types exactly.
+		bool CanPass(int argc, const Any* argv) const
+		{
+			if (argc != GetArity())
+				return false;
+
+			for (int i = 0; i < argc; ++i)
+			{
+				auto tr = GetParamType(i);
+				if (argv[i].GetType() != tr.type)
+					return false;
+				if (argv[i].IsConst() && tr.qualifier == TypeRecord::Pointer)
+					return false;
+			}
+
+			return true;
+		}
+
 	public:
 		//! \brief Get the name of the method.
 		const char* GetName() const { return m_Name; }
@@ -384,45 +1300,346 @@ namespace Meta
 		//! \returns True if the parameters are valid for a call to succeed.
 		inline bool CanCall(const Any& obj, int argc, const Any* argv) const;
 
+		//! \brief Invoke the method on many objects of one type.
+		//! The call is validated and the adjustment to the owner type resolved once for the whole batch, and shared
+		//! arguments are unboxed once, so each object costs only the call itself.
+		//! \param type The exact type of every object.
+		//! \param objects The first object.
+		//! \param count The number of objects.
+		//! \param stride The distance in bytes from one object to the next, e.g. the size of type for an array.
+		//! \param argc The number of arguments of each call.
+		//! \param argv The arguments of the first call.
+		//! \param argvStride The distance in Anys between the arguments of consecutive calls: 0 to pass argv to every object, or argc to give each object its own.
+		//! \param results Receives count return values, or nullptr to discard them.
+		//! \param threads The number of threads to split the objects across, including the calling thread.  The method must
+		//! then be safe to call concurrently on different objects.  At most one thread per object and per hardware thread is
+		//! used.  The other threads are kept and reused across batches, but handing them work still costs a few
+		//! microseconds, so splitting only pays off for large or slow batches.
+		//! \returns False if the method cannot be called on type with the arguments, in which case nothing is called.
+		inline bool CallBatch(const TypeInfo* type, void* objects, size_t count, size_t stride, int argc, const Any* argv, size_t argvStride = 0, Any* results = nullptr, unsigned threads = 1) const;
+
+		//! \brief Invoke the method on every object of an array.  See CallBatch above.
+		template <typename Type> bool CallBatch(Type* objects, size_t count, int argc, const Any* argv, size_t argvStride = 0, Any* results = nullptr, unsigned threads = 1) const
+		{
+			return CallBatch(Get<Type>(), objects, count, sizeof(Type), argc, argv, argvStride, results, threads);
+		}
+
+		//! \brief Tests if the method can be invoked with exactly the given return and parameter types.
+		template <typename ReturnType, typename... ParamTypes> bool CanInvoke() const { return m_Signature == internal::signature<ReturnType, ParamTypes...>::id(); }
+
+		//! \brief Invoke the method directly with native arguments, without boxing anything in an Any.
+		//! The types must match the method exactly; check with CanInvoke.
+		//! \param obj An instance of the owner type, already adjusted from any derived type (see TypeInfo::FindMethodEntry).
+		//! \param args The arguments to pass to the method.
+		//! \returns The return value of the method.
+		template <typename ReturnType, typename... ParamTypes> ReturnType Invoke(void* obj, ParamTypes... args) const
+		{
+			assert((CanInvoke<ReturnType, ParamTypes...>()) && "Invoke types do not match the method");
+			typedef ReturnType (*Invoker)(const Method*, void*, ParamTypes...);
+			return reinterpret_cast<Invoker>(m_Invoker)(this, obj, std::forward<ParamTypes>(args)...);
+		}
+
 		friend class TypeInfo;
 	};
 
-	//! \brief Encodes information about a type.
-	class TypeInfo
+	//! \brief A resolved handle to a plain data member of a specific type, including members inherited from bases.
+	//! Accesses are a single load or store at a precomputed offset, with no virtual calls or Any.
+	template <typename Type> class TypedField
 	{
-		const char* m_Name; //!< The name of the type.
-
-	protected:
-		std::vector<internal::BaseRecord> m_Bases; //!< The list of base types.
-		std::vector<Member*> m_Members; //!< The list of all members of this type.
-		std::vector<Method*> m_Methods; //!< The list of all methods of this type.
+		ptrdiff_t m_Offset; //!< Offset from the start of the resolving type to the variable, or -1 if invalid.
+
+	public:
+		//! \brief Constructs an invalid handle.
+		TypedField() : m_Offset(-1) { }
+
+		//! \brief Constructs a handle for a variable at the given offset.
+		explicit TypedField(ptrdiff_t offset) : m_Offset(offset) { }
+
+		//! \brief Checks if the handle refers to a variable.
+		bool IsValid() const { return m_Offset >= 0; }
+
+		//! \brief Retrieves the offset of the variable from the start of the resolving type.
+		ptrdiff_t GetOffset() const { return m_Offset; }
+
+		//! \brief Retrieves a reference to the variable.
+		//! \param obj An instance of the type the handle was resolved against (not a base or derived type).
+		Type& Ref(void* obj) const { return *reinterpret_cast<Type*>(static_cast<char*>(obj) + m_Offset); }
+
+		//! \brief Retrieves a reference to the variable.
+		//! \param obj An instance of the type the handle was resolved against (not a base or derived type).
+		const Type& Ref(const void* obj) const { return *reinterpret_cast<const Type*>(static_cast<const char*>(obj) + m_Offset); }
+
+		//! \brief Retrieves the value of the variable.
+		Type Get(const void* obj) const { return Ref(obj); }
+
+		//! \brief Sets the value of the variable.
+		void Set(void* obj, const Type& value) const { Ref(obj) = value; }
+	};
+
+	//! \brief Tracks every defined type, finds types by name, and tears the type system down.
+	class Registry
+	{
+		std::vector<TypeInfo*> m_Types; //!< All defined types in order of definition.
+		mutable internal::NameIndex<TypeInfo> m_Index; //!< Index of types by name, rebuilt on lookup after any change.
+		mutable std::atomic<bool> m_Dirty; //!< Whether m_Index is out of date.
+		mutable std::mutex m_Mutex; //!< Guards m_Types and the rebuild of m_Index.
+
+		Registry() : m_Dirty(false) { }
+		Registry(const Registry&); // = delete
+		void operator=(const Registry&); // = delete
+
+		//! \brief Adds a type.  Only to be called by TypeInfo.
+		void Add(TypeInfo* type)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Types.push_back(type);
+			m_Dirty.store(true, std::memory_order_release);
+		}
+
+		//! \brief Removes a type.  Only to be called by TypeInfo.
+		inline void Remove(TypeInfo* type);
+
+	public:
+		//! \brief Retrieves the registry.
+		static Registry& Instance() { static Registry s_Registry; return s_Registry; }
+
+		//! \brief Retrieves all defined types in order of definition.
+		const std::vector<TypeInfo*>& GetTypes() const { return m_Types; }
+
+		//! \brief Find a type by name.  Safe from any number of threads while no type is being defined or destroyed.
+		//! \param name The name of the type, without namespaces.
+		//! \returns The first type defined with that name, or nullptr if there is none.
+		inline const TypeInfo* Find(const char* name) const;
+
+		//! \brief Find the most recently defined type with a name, such as a new version of a type defined by a reloaded plugin.
+		//! \param name The name of the type, without namespaces.
+		//! \returns The last type defined with that name, or nullptr if there is none.
+		inline const TypeInfo* FindLatest(const char* name) const;
+
+		//! \brief Destroys the members and methods of every type, in reverse order of definition, and forgets all types.
+		//! No introspection may be used afterwards.  Types otherwise release their records when they are destroyed.
+		inline void Clear();
+
+		friend class TypeInfo;
+	};
+
+	//! \brief Encodes information about a type.
+	class TypeInfo
+	{
+		const char* m_Name; //!< The name of the type.
+		bool m_Registered; //!< Whether this is a defined type known to the Registry rather than a TypedInfo under construction.
+		size_t m_Size; //!< The size of the type in bytes.
+		size_t m_Alignment; //!< The alignment of the type in bytes.
+		bool m_TriviallyCopyable; //!< Whether objects of the type can be copied as raw bytes.
+		void (*m_Construct)(void*); //!< Default constructs an object in place, or nullptr if the type is not default constructible.
+		void (*m_Destruct)(void*); //!< Destructs an object in place.
+		void (*m_Relocate)(void*, void*); //!< Moves an object into uninitialized storage and destructs the source, or nullptr if the type is not movable.
+		void (*m_Assign)(void*, const void*); //!< Copy assigns an object, or nullptr if the type is not copy assignable.
+
+		TypeInfo(const TypeInfo&); // = delete
+		void operator=(const TypeInfo&); // = delete
+
+	protected:
+		internal::RecordArena m_Arena; //!< Storage for the records in m_Members and m_Methods.
+		std::vector<internal::BaseRecord> m_Bases; //!< The list of base types.
+		std::vector<Member*> m_Members; //!< The list of all members of this type.
+		std::vector<Method*> m_Methods; //!< The list of all methods of this type.
+
+		//! \brief Records the size, alignment and lifecycle of the type.  Only meant to be called by TypedInfo.
+		template <typename Type> void SetLayout()
+		{
+			m_Size = sizeof(Type);
+			m_Alignment = std::alignment_of<Type>::value;
+			m_TriviallyCopyable = std::is_trivially_copyable<Type>::value;
+			m_Construct = internal::type_lifecycle<Type>::constructor();
+			m_Destruct = internal::type_lifecycle<Type>::destructor();
+			m_Relocate = internal::type_relocate<Type>::relocator();
+			m_Assign = internal::type_assign<Type>::assigner();
+		}
+
+	private:
+		mutable std::atomic<bool> m_Frozen; //!< Whether the indices below are complete and will not change again.
+		mutable internal::NameIndex<Member> m_MemberIndex; //!< Index of own and inherited members, built when the type is defined.
+		mutable internal::NameIndex<Method> m_MethodIndex; //!< Index of own and inherited methods, built when the type is defined.
+		mutable std::vector<internal::NameIndex<Member>::Entry> m_AllMembers; //!< Every own and inherited member, bases first, built when the type is defined.
+		mutable std::vector<internal::BaseRecord> m_Ancestors; //!< Open-addressed table of this type and all its bases with accumulated offsets; empty slots have a null type.
+
+		//! \brief Hashes a TypeInfo pointer into the ancestor table.
+		static size_t HashType(const TypeInfo* type) { return (reinterpret_cast<size_t>(type) >> 3) * 2654435761u; }
+
+		//! \brief Finds the ancestor record for a type.  Used by every checked access, call and Any conversion; once the type
+		//! is frozen it costs one atomic load and a probe, and is safe from any number of threads.
+		//! \returns The record or nullptr if base is neither this type nor one of its bases.
+		const internal::BaseRecord* FindAncestor(const TypeInfo* base) const
+		{
+			Freeze();
+			const size_t mask = m_Ancestors.size() - 1;
+			for (size_t i = HashType(base) & mask; m_Ancestors[i].type != nullptr; i = (i + 1) & mask)
+				if (m_Ancestors[i].type == base)
+					return &m_Ancestors[i];
+			return nullptr;
+		}
+
+		//! \brief Guards building the indices of every type.
+		static std::mutex& GetFreezeMutex() { static std::mutex s_Mutex; return s_Mutex; }
+
+		//! \brief Builds the indices of this type and its bases.  The caller holds the freeze mutex.
+		//! Bases whose definitions have not run yet, as during static initialization, are left out and the type stays unfrozen,
+		//! so its indices are rebuilt once they are defined.
+		void FreezeLocked() const
+		{
+			if (m_Frozen.load(std::memory_order_relaxed))
+				return;
+
+			bool complete = m_Registered;
+			for (auto& b : m_Bases)
+			{
+				if (b.type->m_Registered)
+					b.type->FreezeLocked();
+				complete = complete && b.type->m_Frozen.load(std::memory_order_relaxed);
+			}
+
+			BuildAncestors();
+			BuildIndices();
+			if (complete)
+				m_Frozen.store(true, std::memory_order_release);
+		}
+
+		//! \brief Builds the ancestor table from this type and its (already frozen) bases.
+		void BuildAncestors() const
+		{
+			// this type first, then each base's ancestors in turn, so the first path found wins like a depth-first search
+			std::vector<internal::BaseRecord> ancestors(1, internal::BaseRecord(this, 0));
+			for (auto& b : m_Bases)
+				if (b.type->m_Registered)
+					for (auto& a : b.type->m_Ancestors)
+					if (a.type != nullptr)
+						ancestors.push_back(internal::BaseRecord(a.type, a.offset + b.offset));
+
+			size_t size = 2;
+			while (size < ancestors.size() * 2)
+				size *= 2;
+
+			m_Ancestors.assign(size, internal::BaseRecord(nullptr, 0));
+			for (auto& a : ancestors)
+			{
+				size_t i = HashType(a.type) & (size - 1);
+				while (m_Ancestors[i].type != nullptr && m_Ancestors[i].type != a.type)
+					i = (i + 1) & (size - 1);
+				if (m_Ancestors[i].type == nullptr)
+					m_Ancestors[i] = a;
+			}
+		}
+
+		//! \brief Builds the flattened member and method indices from this type and its (already frozen) bases.
+		void BuildIndices() const
+		{
+			std::vector<internal::NameIndex<Member>::Entry> members;
+			std::vector<internal::NameIndex<Method>::Entry> methods;
+
+			// every member in layout order, including members hidden by a member of the same name
+			m_AllMembers.clear();
+			for (auto& b : m_Bases)
+			{
+				if (!b.type->m_Registered)
+					continue;
+				for (auto e : b.type->m_AllMembers)
+				{
+					e.offset += b.offset;
+					m_AllMembers.push_back(e);
+				}
+			}
+			for (auto m : m_Members)
+				m_AllMembers.push_back(internal::NameIndex<Member>::Entry(m, 0));
+
+			for (auto m : m_Members)
+				members.push_back(internal::NameIndex<Member>::Entry(m, 0));
+			for (auto m : m_Methods)
+				methods.push_back(internal::NameIndex<Method>::Entry(m, 0));
+
+			for (auto& b : m_Bases)
+			{
+				if (!b.type->m_Registered)
+					continue;
+				for (auto e : b.type->m_MemberIndex.GetEntries())
+				{
+					e.offset += b.offset;
+					members.push_back(e);
+				}
+				for (auto e : b.type->m_MethodIndex.GetEntries())
+				{
+					e.offset += b.offset;
+					methods.push_back(e);
+				}
+			}
+
+			m_MemberIndex.Build(members);
+			m_MethodIndex.Build(methods);
+		}
+
+		//! \brief Destroys the member and method records and leaves the type empty.
+		void Release()
+		{
+			for (auto m : m_Members)
+				m->~Member();
+			for (auto m : m_Methods)
+				m->~Method();
+
+			m_Members.clear();
+			m_Methods.clear();
+			m_Bases.clear();
+			m_Arena.Release();
+
+			m_MemberIndex = internal::NameIndex<Member>();
+			m_MethodIndex = internal::NameIndex<Method>();
+			m_AllMembers.clear();
+			m_Ancestors.clear();
+			m_Frozen = false;
+		}
+
+		friend class Registry;
 
 	public:
 		//! \brief Constructor for type info.
 		//! \param name The name of the type.
-		TypeInfo(const char* name)
+		TypeInfo(const char* name) : m_Name(name), m_Registered(false), m_Size(0), m_Alignment(0), m_TriviallyCopyable(false), m_Construct(nullptr), m_Destruct(nullptr), m_Relocate(nullptr), m_Assign(nullptr), m_Frozen(false)
 		{
 			int nested = 0;
 			// trim off the namespaces from the name; account for possible template specializations
-			for (const char* m_Name = name + std::strlen(name) - 1; m_Name != name; --m_Name)
+			for (const char* c = name + std::strlen(name) - 1; c != name; --c)
 			{
-				if (*m_Name == '>')
+				if (*c == '>')
 					++nested;
-				else if (*m_Name == '<')
+				else if (*c == '<')
 					--nested;
-				else if (nested == 0 && *m_Name == ':')
+				else if (nested == 0 && *c == ':')
+				{
+					m_Name = c + 1;
 					break;
+				}
 			}
 		}
 
-		//! \brief Copy constructor for type info.
-		TypeInfo(const TypeInfo& type) : m_Name(type.m_Name), m_Bases(type.m_Bases), m_Members(type.m_Members), m_Methods(type.m_Methods)
+		//! \brief Move constructor for type info, used to define a type from a TypedInfo.  The lookup tables are built here if
+		//! every base is already defined, and otherwise on first use.
+		TypeInfo(TypeInfo&& type) : m_Name(type.m_Name), m_Registered(true), m_Size(type.m_Size), m_Alignment(type.m_Alignment), m_TriviallyCopyable(type.m_TriviallyCopyable), m_Construct(type.m_Construct), m_Destruct(type.m_Destruct), m_Relocate(type.m_Relocate), m_Assign(type.m_Assign), m_Arena(std::move(type.m_Arena)), m_Bases(std::move(type.m_Bases)), m_Members(std::move(type.m_Members)), m_Methods(std::move(type.m_Methods)), m_Frozen(false)
 		{
 			for (auto s_TypeInfo : m_Members)
 				s_TypeInfo->SetOwner(this);
 
 			for (auto s_TypeInfo : m_Methods)
 				s_TypeInfo->SetOwner(this);
+
+			Registry::Instance().Add(this);
+			Freeze();
+		}
+
+		//! \brief Destroys the member and method records.
+		~TypeInfo()
+		{
+			Release();
+			if (m_Registered)
+				Registry::Instance().Remove(this);
 		}
 
 		//! \brief Tests if this type is derived from another type.
@@ -430,11 +1647,7 @@ namespace Meta
 		//! \returns True if this type derives from base either directly or indirectly.
 		bool IsDerivedFrom(const TypeInfo* base) const
 		{
-			for (auto& b : m_Bases)
-				if (b.type == base || b.type->IsDerivedFrom(base))
-					return true;
-
-			return false;
+			return base != this && FindAncestor(base) != nullptr;
 		}
 
 		//! \brief Tests is this type is derived from anothe type or is the same type.
@@ -444,9 +1657,7 @@ namespace Meta
 		{
 			if (base == this)
 				return true;
-			if (IsDerivedFrom(base))
-				return true;
-			return false;
+			return FindAncestor(base) != nullptr;
 		}
 
 		//! \brief Adjust a pointer of this type to a derived type.
@@ -458,14 +1669,8 @@ namespace Meta
 			if (base == this)
 				return ptr;
 
-			for (auto& b : m_Bases)
-			{
-				void* rs = b.type->Adjust(base, static_cast<char*>(ptr) + b.offset);
-				if (rs != nullptr)
-					return rs;
-			}
-
-			return nullptr;
+			auto a = FindAncestor(base);
+			return a != nullptr ? static_cast<char*>(ptr) + a->offset : nullptr;
 		}
 		
 		//! \brief Adjust a pointer of this type to a derived type.
@@ -480,23 +1685,98 @@ namespace Meta
 		//! \brief Get the name of the type.
 		const char* GetName() const { return m_Name; }
 
+		//! \brief Get the size of the type in bytes.
+		size_t GetSize() const { return m_Size; }
+
+		//! \brief Get the alignment of the type in bytes.
+		size_t GetAlignment() const { return m_Alignment; }
+
+		//! \brief Checks if objects of the type can be copied as raw bytes.
+		bool IsTriviallyCopyable() const { return m_TriviallyCopyable; }
+
+		//! \brief Checks if objects of the type can be default constructed with Construct.
+		bool CanConstruct() const { return m_Construct != nullptr; }
+
+		//! \brief Default constructs an object of the type in place.
+		//! \param obj Suitably sized and aligned storage.
+		void Construct(void* obj) const { m_Construct(obj); }
+
+		//! \brief Destructs an object of the type in place.
+		void Destruct(void* obj) const { m_Destruct(obj); }
+
+		//! \brief Checks if objects of the type can be moved with Relocate.
+		bool CanRelocate() const { return m_Relocate != nullptr; }
+
+		//! \brief Moves an object of the type into uninitialized storage and destructs the source.
+		void Relocate(void* dst, void* src) const { m_Relocate(dst, src); }
+
+		//! \brief Checks if objects of the type can be copied with Assign.
+		bool CanAssign() const { return m_Assign != nullptr; }
+
+		//! \brief Copy assigns one object of the type to another.
+		void Assign(void* dst, const void* src) const { m_Assign(dst, src); }
+
+		//! \brief Get the direct base types and their offsets.
+		const std::vector<internal::BaseRecord>& GetBases() const { return m_Bases; }
+
+		//! \brief Get the members declared by this type, not including those of its bases.
+		const std::vector<Member*>& GetMembers() const { return m_Members; }
+
+		//! \brief Get the methods declared by this type, not including those of its bases.
+		const std::vector<Method*>& GetMethods() const { return m_Methods; }
+
+		//! \brief Get every member of this type and its bases: the members of each base in turn, then those declared by this
+		//! type, including members hidden by a later member of the same name.  Each entry's offset converts a pointer to this
+		//! type into a pointer to the member's owner.  This is the walk behind FieldPlan, Layout, Migrator and SoaArray.
+		const std::vector<internal::NameIndex<Member>::Entry>& GetAllMembers() const
+		{
+			Freeze();
+			return m_AllMembers;
+		}
+
+		//! \brief Builds the lookup indices and ancestor table if they are not complete yet.  Types are frozen when they are
+		//! defined, so after static initialization this is a single atomic load and lookups are pure reads that any number of
+		//! threads may make at once. No members, methods or bases may be added to this type or its bases afterwards.
+		void Freeze() const
+		{
+			if (m_Frozen.load(std::memory_order_acquire))
+				return;
+
+			std::lock_guard<std::mutex> lock(GetFreezeMutex());
+			FreezeLocked();
+		}
+
 		//! \brief Find a member of this type or any base type.
 		//! \param name The name of the member to look up.
 		//! \returns The Member named by name or nullptr if no such member exists.
 		Member* FindMember(const char* name) const
 		{
-			for (auto s_TypeInfo : m_Members)
-				if (std::strcmp(s_TypeInfo->GetName(), name) == 0)
-					return s_TypeInfo;
+			auto e = FindMemberEntry(name);
+			return e != nullptr ? e->item : nullptr;
+		}
 
-			for (auto& b : m_Bases)
-			{
-				auto s_TypeInfo = b.type->FindMember(name);
-				if (s_TypeInfo != nullptr)
-					return s_TypeInfo;
-			}
+		//! \brief Find a member of this type or any base type, along with the offset from this type to the member's owner.
+		//! \param name The name of the member to look up.
+		//! \returns The index entry for name or nullptr if no such member exists.
+		const internal::NameIndex<Member>::Entry* FindMemberEntry(const char* name) const
+		{
+			META_PROFILE_SCOPE(FindMemberHit, this, name);
+			Freeze();
+			auto e = m_MemberIndex.Find(name);
+			if (e == nullptr)
+				META_PROFILE_MISS();
+			return e;
+		}
 
-			return nullptr;
+		//! \brief Resolve a plain data member of this type or any base type to a direct access handle.
+		//! \param name The name of the member to look up.
+		//! \returns A handle for instances of this type, or an invalid handle if the member does not exist, is accessed through functions, or is not of type Type.
+		template <typename Type> TypedField<Type> FindField(const char* name) const
+		{
+			auto e = FindMemberEntry(name);
+			if (e == nullptr || !e->item->IsField() || e->item->GetType() != Get<Type>())
+				return TypedField<Type>();
+			return TypedField<Type>(e->offset + e->item->GetOffset());
 		}
 
 		//! \brief Find a method of this type or any base type.
@@ -504,26 +1784,95 @@ namespace Meta
 		//! \returns The Method named by name or nullptr if no such method exists.
 		Method* FindMethod(const char* name) const
 		{
-			for (auto s_TypeInfo : m_Methods)
-				if (std::strcmp(s_TypeInfo->GetName(), name) == 0)
-					return s_TypeInfo;
+			auto e = FindMethodEntry(name);
+			return e != nullptr ? e->item : nullptr;
+		}
 
-			for (auto& b : m_Bases)
+		//! \brief Find a method of this type or any base type, along with the offset from this type to the method's owner.
+		//! \param name The name of the method to look up.
+		//! \returns The index entry for name or nullptr if no such method exists.
+		const internal::NameIndex<Method>::Entry* FindMethodEntry(const char* name) const
+		{
+			META_PROFILE_SCOPE(FindMethodHit, this, name);
+			Freeze();
+			auto e = m_MethodIndex.Find(name);
+			if (e == nullptr)
+				META_PROFILE_MISS();
+			return e;
+		}
+	};
+
+	void Registry::Remove(TypeInfo* type)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (auto i = m_Types.begin(); i != m_Types.end(); ++i)
+		{
+			if (*i == type)
 			{
-				auto s_TypeInfo = b.type->FindMethod(name);
-				if (s_TypeInfo != nullptr)
-					return s_TypeInfo;
+				m_Types.erase(i);
+				m_Dirty.store(true, std::memory_order_release);
+				return;
 			}
+		}
+	}
 
-			return nullptr;
+	const TypeInfo* Registry::Find(const char* name) const
+	{
+		if (m_Dirty.load(std::memory_order_acquire))
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Dirty.load(std::memory_order_relaxed))
+			{
+				std::vector<internal::NameIndex<TypeInfo>::Entry> types;
+				for (auto t : m_Types)
+					types.push_back(internal::NameIndex<TypeInfo>::Entry(t, 0));
+				m_Index.Build(types);
+				m_Dirty.store(false, std::memory_order_release);
+			}
 		}
-	};
+
+		auto e = m_Index.Find(name);
+		return e != nullptr ? e->item : nullptr;
+	}
+
+	const TypeInfo* Registry::FindLatest(const char* name) const
+	{
+		for (auto i = m_Types.rbegin(); i != m_Types.rend(); ++i)
+			if (std::strcmp((*i)->GetName(), name) == 0)
+				return *i;
+		return nullptr;
+	}
+
+	void Registry::Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (auto i = m_Types.rbegin(); i != m_Types.rend(); ++i)
+		{
+			(*i)->Release();
+			(*i)->m_Registered = false;
+		}
+		m_Types.clear();
+		m_Dirty.store(true, std::memory_order_release);
+	}
 
 	inline void* Any::GetPointer(const TypeInfo* type) const
 	{
 		return m_TypeRecord.type->Adjust(type, GetPointer());
 	}
 
+#if META_PROFILE
+	void Profiler::Dump(std::ostream& out) const
+	{
+		Each([&out](const TypeInfo* type, const char* name, Event event, const Counter& c)
+		{
+			out << (type != nullptr ? type->GetName() : "(none)") << '\t' << name << '\t' << GetEventName(event) << '\t' << c.count;
+			if (c.samples != 0)
+				out << '\t' << c.nanoseconds / c.samples << " ns mean\t" << c.maxNanoseconds << " ns max";
+			out << '\n';
+		});
+	}
+#endif
+
 	bool Member::CanGet(const Any& obj) const
 	{
 		if (!obj.GetType()->IsSameOrDerivedFrom(m_Owner))
@@ -533,6 +1882,7 @@ namespace Meta
 
 	Any Member::Get(const Any& obj) const
 	{
+		META_PROFILE_SCOPE(MemberGet, m_Owner, m_Name);
 		return DoGet(obj);
 	}
 
@@ -551,11 +1901,13 @@ namespace Meta
 
 	void Member::Set(const Any& obj, const Any& in) const
 	{
+		META_PROFILE_SCOPE(MemberSet, m_Owner, m_Name);
 		DoSet(obj, in);
 	}
 
 	Any Method::Call(const Any& obj, int argc, const Any* argv) const
 	{
+		META_PROFILE_SCOPE(MethodCall, m_Owner, m_Name);
 		return DoCall(obj, argc, argv);
 	}
 
@@ -564,18 +1916,41 @@ namespace Meta
 		if (!obj.GetType()->IsSameOrDerivedFrom(m_Owner))
 			return false;
 
-		if (argc != GetArity())
+		return CanPass(argc, argv);
+	}
+
+	bool Method::CallBatch(const TypeInfo* type, void* objects, size_t count, size_t stride, int argc, const Any* argv, size_t argvStride, Any* results, unsigned threads) const
+	{
+		if (!type->IsSameOrDerivedFrom(m_Owner))
 			return false;
 
-		for (int i = 0; i < argc; ++i)
-		{
-			auto tr = GetParamType(i);
-			if (argv[i].GetType() != tr.type)
-				return false;
-			if (argv[i].IsConst() && tr.qualifier == TypeRecord::Pointer)
+		const size_t lists = argvStride != 0 ? count : 1;
+		for (size_t i = 0; i != lists; ++i)
+			if (!CanPass(argc, argv + i * argvStride))
 				return false;
+
+		if (count == 0)
+			return true;
+
+		char* first = static_cast<char*>(type->Adjust(m_Owner, objects));
+		if (threads > internal::batch_workers::GetMaxThreads())
+			threads = internal::batch_workers::GetMaxThreads();
+		if (threads > count)
+			threads = static_cast<unsigned>(count);
+		if (threads <= 1)
+		{
+			DoCallBatch(first, count, stride, argv, argvStride, results);
+			return true;
 		}
 
+		// the calling thread takes the last chunk while the kept workers take the others
+		auto chunk = [=](size_t t)
+		{
+			const size_t begin = count * t / threads;
+			const size_t end = count * (t + 1) / threads;
+			DoCallBatch(first + begin * stride, end - begin, stride, argv + begin * argvStride, argvStride, results != nullptr ? results + begin : nullptr);
+		};
+		internal::batch_workers::Instance().Run(threads, chunk);
 		return true;
 	}
 
@@ -588,7 +1963,7 @@ namespace Meta
 			MemberType Type::*m_Member;
 
 		public:
-			TypeMember(const char* name, const TypeInfo* type, MemberType Type::*member) : Member(name, type), m_Member(member) { }
+			TypeMember(const char* name, const TypeInfo* type, MemberType Type::*member) : Member(name, type, reinterpret_cast<const char*>(&(reinterpret_cast<const Type*>(0x1000)->*member)) - reinterpret_cast<const char*>(0x1000)), m_Member(member) { }
 
 			virtual bool IsMutable() const override { return true; }
 
@@ -640,111 +2015,89 @@ namespace Meta
 		};
 
 		// helpers to deal with the possibility of a void return m_Type
-		template <typename Type, typename ReturnType> struct do_call0
+		template <typename Type, typename ReturnType, typename... ParamTypes> struct do_call
 		{
-			static Any call(ReturnType (Type::*method)(), Type* obj, int argc, const Any* argv)
+			template <size_t... Indices> static Any call(ReturnType (Type::*method)(ParamTypes...), Type* obj, const Any* argv, std::index_sequence<Indices...>)
 			{
-				return internal::make_any<ReturnType>::make((obj->*method)());
+				return internal::make_any<ReturnType>::make((obj->*method)(any_cast<ParamTypes>(argv[Indices])...));
 			}
-		};
 
-		template <typename Type> struct do_call0<Type, void>
-		{
-			static Any call(void (Type::*method)(), Type* obj, int argc, const Any* argv)
+			template <typename... ArgTypes> static void invoke(ReturnType (Type::*method)(ParamTypes...), Type* obj, Any* result, ArgTypes&&... args)
 			{
-				(obj->*method)();
-				return Any();
+				if (result != nullptr)
+					*result = internal::make_any<ReturnType>::make((obj->*method)(std::forward<ArgTypes>(args)...));
+				else
+					(obj->*method)(std::forward<ArgTypes>(args)...);
 			}
 		};
 
-		//! \brief A method with no parameters.
-		template <typename Type, typename ReturnType>
-		class Method0 : public Method
+		template <typename Type, typename... ParamTypes> struct do_call<Type, void, ParamTypes...>
 		{
-			ReturnType (Type::*method)();
-
-		public:
-			virtual TypeRecord GetReturnType() const override { return internal::make_type_record<ReturnType>::type(); }
-
-			virtual TypeRecord GetParamType(int name) const override { return TypeRecord(); }
-
-			virtual int GetArity() const override { return 0; }
-
-			Method0(const char* name, ReturnType (Type::*method)()) : Method(name), method(method) { }
-
-			virtual Any DoCall(const Any& obj, int argc, const Any* argv) const override { return do_call0<Type, ReturnType>::call(method, obj.GetPointer<Type>(), argc, argv); }
-		};
-
-		// helpers to deal with the possibility of a void return m_Type
-		template <typename Type, typename ReturnType, typename ParamType0> struct do_call1
-		{
-			static Any call(ReturnType (Type::*method)(ParamType0), Type* obj, int argc, const Any* argv)
+			template <size_t... Indices> static Any call(void (Type::*method)(ParamTypes...), Type* obj, const Any* argv, std::index_sequence<Indices...>)
 			{
-				return internal::make_any<ReturnType>::make((obj->*method)(any_cast<ParamType0>(argv[0])));
+				(obj->*method)(any_cast<ParamTypes>(argv[Indices])...);
+				return Any();
 			}
-		};
 
-		template <typename Type, typename ParamType0> struct do_call1<Type, void, ParamType0>
-		{
-			static Any call(void (Type::*method)(ParamType0), Type* obj, int argc, const Any* argv)
+			template <typename... ArgTypes> static void invoke(void (Type::*method)(ParamTypes...), Type* obj, Any*, ArgTypes&&... args)
 			{
-				(obj->*method)(any_cast<ParamType0>(argv[0]));
-				return Any();
+				(obj->*method)(std::forward<ArgTypes>(args)...);
 			}
 		};
 
-		//! \brief A method with one parameter.
-		template <typename Type, typename ReturnType, typename ParamType0>
-		class Method1 : public Method
-		{
-			ReturnType (Type::*method)(ParamType0);
-
-		public:
-			virtual TypeRecord GetReturnType() const override { return internal::make_type_record<ReturnType>::type(); }
-
-			virtual TypeRecord GetParamType(int name) const override { if (name == 0) return internal::make_type_record<ParamType0>::type(); else return TypeRecord(); }
-
-			virtual int GetArity() const override { return 1; }
-
-			Method1(const char* name, ReturnType (Type::*method)(ParamType0)) : Method(name), method(method) { }
-
-			virtual Any DoCall(const Any& obj, int argc, const Any* argv) const override { return do_call1<Type, ReturnType, ParamType0>::call(method, obj.GetPointer<Type>(), argc, argv); }
-		};
-
-		// helpers to deal with the possibility of a void return m_Type
-		template <typename Type, typename ReturnType, typename ParamType0, typename ParamType1> struct do_call2
+		//! \brief Implements Method::CallBatch for a typed method.
+		template <typename Type, typename ReturnType, typename... ParamTypes> struct do_call_batch
 		{
-			static Any call(ReturnType (Type::*method)(ParamType0, ParamType1), Type* obj, int argc, const Any* argv)
+			template <size_t... Indices> static void call(ReturnType (Type::*method)(ParamTypes...), char* obj, size_t count, size_t stride, const Any* argv, size_t argvStride, Any* results, std::index_sequence<Indices...>)
 			{
-				return internal::make_any<ReturnType>::make((obj->*method)(any_cast<ParamType0>(argv[0]), any_cast<ParamType1>(argv[1])));
+				typedef do_call<Type, ReturnType, ParamTypes...> caller;
+				if (argvStride == 0)
+				{
+					// the shared arguments are unboxed once for the whole batch
+					std::tuple<ParamTypes...> args(any_cast<ParamTypes>(argv[Indices])...);
+					(void)args; // unused when there are no parameters
+					for (size_t i = 0; i != count; ++i, obj += stride)
+						caller::invoke(method, reinterpret_cast<Type*>(obj), results != nullptr ? results + i : nullptr, std::get<Indices>(args)...);
+				}
+				else
+				{
+					for (size_t i = 0; i != count; ++i, obj += stride, argv += argvStride)
+						caller::invoke(method, reinterpret_cast<Type*>(obj), results != nullptr ? results + i : nullptr, any_cast<ParamTypes>(argv[Indices])...);
+				}
 			}
 		};
 
-		template <typename Type, typename ParamType0, typename ParamType1>	struct do_call2<Type, void, ParamType0, ParamType1>
+		//! \brief A method with any number of parameters.
+		template <typename Type, typename ReturnType, typename... ParamTypes>
+		class TypedMethod : public Method
 		{
-			static Any call(void (Type::*method)(ParamType0, ParamType1), Type* obj, int argc, const Any* argv)
+			ReturnType (Type::*method)(ParamTypes...);
+
+			//! \brief The thunk behind Method::Invoke.
+			static ReturnType invoke(const Method* self, void* obj, ParamTypes... args)
 			{
-				(obj->*method)(any_cast<ParamType0>(argv[0]), any_cast<ParamType1>(argv[1]));
-				return Any();
+				return (static_cast<Type*>(obj)->*static_cast<const TypedMethod*>(self)->method)(std::forward<ParamTypes>(args)...);
 			}
-		};
-
-		//! \brief A method with two parameters.
-		template <typename Type, typename ReturnType, typename ParamType0, typename ParamType1>
-		class Method2 : public Method
-		{
-			ReturnType (Type::*method)(ParamType0, ParamType1);
 
 		public:
 			virtual TypeRecord GetReturnType() const override { return internal::make_type_record<ReturnType>::type(); }
 
-			virtual TypeRecord GetParamType(int name) const override { if (name == 0) return internal::make_type_record<ParamType0>::type(); else if (name == 1) return internal::make_type_record<ParamType1>::type(); else return TypeRecord(); }
+			virtual TypeRecord GetParamType(int name) const override
+			{
+				const TypeRecord params[] = { internal::make_type_record<ParamTypes>::type()..., TypeRecord() };
+				return name >= 0 && name < GetArity() ? params[name] : TypeRecord();
+			}
+
+			virtual int GetArity() const override { return static_cast<int>(sizeof...(ParamTypes)); }
 
-			virtual int GetArity() const override { return 2; }
+			TypedMethod(const char* name, ReturnType (Type::*method)(ParamTypes...)) : Method(name, signature<ReturnType, ParamTypes...>::id(), reinterpret_cast<void (*)()>(&invoke)), method(method) { }
 
-			Method2(const char* name, ReturnType (Type::*method)(ParamType0, ParamType1)) : Method(name), method(method) { }
+			virtual Any DoCall(const Any& obj, int argc, const Any* argv) const override { return do_call<Type, ReturnType, ParamTypes...>::call(method, obj.GetPointer<Type>(), argv, std::index_sequence_for<ParamTypes...>()); }
 
-			virtual Any DoCall(const Any& obj, int argc, const Any* argv) const override { return do_call2<Type, ReturnType, ParamType0, ParamType1>::call(method, obj.GetPointer<Type>(), argc, argv); }
+			virtual void DoCallBatch(char* first, size_t count, size_t stride, const Any* argv, size_t argvStride, Any* results) const override
+			{
+				do_call_batch<Type, ReturnType, ParamTypes...>::call(method, first, count, stride, argv, argvStride, results, std::index_sequence_for<ParamTypes...>());
+			}
 		};
 
 		//! \brief Holder for TypeInfo external to a type, used when adding introspection to types that cannot be modified.
@@ -754,47 +2107,380 @@ namespace Meta
 		};
 
 		//! \brief Utility class to initialize a TypeInfo, invoked by META_DEFINE_EXTERN or META_DEFINE.
+		//! The builder methods are rvalue-qualified so that the finished chain is moved into the defined TypeInfo.
 		template <typename Type, bool IsClass> struct TypedInfo : public TypeInfo
 		{
 			//! \brief Construct the type.
-			TypedInfo(const char* name) : TypeInfo(name) { }
+			TypedInfo(const char* name) : TypeInfo(name) { SetLayout<Type>(); }
 
 			//! \brief Add a base to this type.
-			template <typename BaseType> TypedInfo& base() { static_assert(std::is_base_of<BaseType, Type>::value && !std::is_same<BaseType, Type>::value, "incorrect base"); m_Bases.push_back(BaseRecord(Get<BaseType>(), reinterpret_cast<ptrdiff_t>(static_cast<const BaseType*>(reinterpret_cast<const Type*>(0x1000))) - 0x1000)); return *this; }
+			template <typename BaseType> TypedInfo&& base() && { static_assert(std::is_base_of<BaseType, Type>::value && !std::is_same<BaseType, Type>::value, "incorrect base"); m_Bases.push_back(BaseRecord(Get<BaseType>(), reinterpret_cast<ptrdiff_t>(static_cast<const BaseType*>(reinterpret_cast<const Type*>(0x1000))) - 0x1000)); return std::move(*this); }
 
 			//! \brief Add a read-write member definition to this type which will be accessed directly.
 			//! \param name The name of the member.
 			//! \param member A pointer to the member.
-			template <typename MemberType> typename std::enable_if<!std::is_member_function_pointer<MemberType>::value, TypedInfo&>::type member(const char* name, MemberType Type::*member) { m_Members.push_back(new TypeMember<Type, typename std::remove_reference<MemberType>::type>(name, Get<MemberType>(), member)); return *this; }
+			template <typename MemberType> typename std::enable_if<!std::is_member_function_pointer<MemberType>::value, TypedInfo&&>::type member(const char* name, MemberType Type::*member) && { m_Members.push_back(m_Arena.Create<TypeMember<Type, typename std::remove_reference<MemberType>::type>>(name, Get<MemberType>(), member)); return std::move(*this); }
 
 			//! \brief Add a read-only member definition to this type which will be accessed by a getter member function.
 			//! \param name The name of the member.
 			//! \param getter A pointer to the getter member function.
-			template <typename MemberType> TypedInfo& member(const char* name, MemberType (Type::*getter)() const) { m_Members.push_back(new TypeMemberGetter<Type, typename std::remove_reference<MemberType>::type, MemberType (Type::*)() const>(name, Get<MemberType>(), getter)); return *this; }
+			template <typename MemberType> TypedInfo&& member(const char* name, MemberType (Type::*getter)() const) && { m_Members.push_back(m_Arena.Create<TypeMemberGetter<Type, typename std::remove_reference<MemberType>::type, MemberType (Type::*)() const>>(name, Get<MemberType>(), getter)); return std::move(*this); }
 
 			//! \brief Add a read-only member definition to this type which will be accessed by a getter member function.  Allows passing nullptr as a third parameter to indicate the lack of a setter.
 			//! \param name The name of the member.
 			//! \param getter A pointer to the getter member function.
-			template <typename MemberType> TypedInfo& member(const char* name, MemberType (Type::*getter)() const, std::nullptr_t) { m_Members.push_back(new TypeMemberGetter<Type, typename std::remove_reference<MemberType>::type, MemberType (Type::*)() const>(name, Get<MemberType>(), getter)); return *this; }
+			template <typename MemberType> TypedInfo&& member(const char* name, MemberType (Type::*getter)() const, std::nullptr_t) && { m_Members.push_back(m_Arena.Create<TypeMemberGetter<Type, typename std::remove_reference<MemberType>::type, MemberType (Type::*)() const>>(name, Get<MemberType>(), getter)); return std::move(*this); }
 
 			//! \brief Add a read-write member definition to this type which will be accessed by getter and setter member functions.
 			//! \param name The name of the member.
 			//! \param getter A pointer to the getter member function.
 			//! \param setter A pointer to the setter member function.
-			template <typename MemberType, typename SetterType, typename SetterReturnType> TypedInfo& member(const char* name, MemberType (Type::*getter)() const, SetterReturnType (Type::*setter)(SetterType)) { m_Members.push_back(new TypeMemberGetterSetter<Type, typename std::remove_reference<MemberType>::type, MemberType (Type::*)() const, SetterReturnType (Type::*)(SetterType)>(name, Get<MemberType>(), getter, setter)); return *this; }
+			template <typename MemberType, typename SetterType, typename SetterReturnType> TypedInfo&& member(const char* name, MemberType (Type::*getter)() const, SetterReturnType (Type::*setter)(SetterType)) && { m_Members.push_back(m_Arena.Create<TypeMemberGetterSetter<Type, typename std::remove_reference<MemberType>::type, MemberType (Type::*)() const, SetterReturnType (Type::*)(SetterType)>>(name, Get<MemberType>(), getter, setter)); return std::move(*this); }
 
-			// add method definitions for a m_Type
-			template <typename ReturnType> TypedInfo& method(const char* name, ReturnType (Type::*method)()) { m_Methods.push_back(new Method0<Type, ReturnType>(name, method)); return *this; }
-			template <typename ReturnType, typename ParamType0> TypedInfo& method(const char* name, ReturnType (Type::*method)(ParamType0)) { m_Methods.push_back(new Method1<Type, ReturnType, ParamType0>(name, method)); return *this; }
-			template <typename ReturnType, typename ParamType0, typename ParamType1> TypedInfo& method(const char* name, ReturnType (Type::*method)(ParamType0, ParamType1)) { m_Methods.push_back(new Method2<Type, ReturnType, ParamType0, ParamType1>(name, method)); return *this; }
+			//! \brief Add a method definition to this type.
+			//! \param name The name of the method.
+			//! \param method A pointer to the member function.
+			template <typename ReturnType, typename... ParamTypes> TypedInfo&& method(const char* name, ReturnType (Type::*method)(ParamTypes...)) && { m_Methods.push_back(m_Arena.Create<TypedMethod<Type, ReturnType, ParamTypes...>>(name, method)); return std::move(*this); }
 		};
 
 		//! \brief Utility class to initialize a TypeInfo, invoked by META_DEFINE_EXTERN, but which cannot have base types, member variables, or member functions (e.g. primitive types).
 		template <typename Type> struct TypedInfo<Type, false> : public TypeInfo
 		{
-			TypedInfo(const char* name) : TypeInfo(name) { }
+			TypedInfo(const char* name) : TypeInfo(name) { SetLayout<Type>(); }
+		};
+
+		//! \brief Constructs the return value of a StaticMethod call in place and retrieves it.
+		template <typename ReturnType> struct static_return
+		{
+			static void store(void* ret, ReturnType&& value) { new (ret) ReturnType(std::move(value)); }
+
+			static ReturnType invoke(void (*call)(void*, void*, void* const*), void* obj, void* const* argv)
+			{
+				typename std::aligned_storage<sizeof(ReturnType), std::alignment_of<ReturnType>::value>::type ret;
+				call(obj, &ret, argv);
+				ReturnType& value = *reinterpret_cast<ReturnType*>(&ret);
+				ReturnType result(std::move(value));
+				value.~ReturnType();
+				return result;
+			}
+		};
+
+		//! \brief Returns references from a StaticMethod call as pointers.
+		template <typename ReturnType> struct static_return<ReturnType&>
+		{
+			static void store(void* ret, ReturnType& value) { *static_cast<ReturnType**>(ret) = &value; }
+
+			static ReturnType& invoke(void (*call)(void*, void*, void* const*), void* obj, void* const* argv)
+			{
+				ReturnType* ret;
+				call(obj, &ret, argv);
+				return *ret;
+			}
+		};
+
+		//! \brief Calls a StaticMethod that has no return value.
+		template <> struct static_return<void>
+		{
+			static void invoke(void (*call)(void*, void*, void* const*), void* obj, void* const* argv) { call(obj, nullptr, argv); }
+		};
+	}
+
+	//! \brief A compiled walk over every value of a reflected type, shared by the Serializer and the Hasher.
+	//! The members of the type, its bases and its reflected class members are flattened into steps at fixed offsets.
+	//! Trivially copyable fields become byte ranges, adjacent ones merged into single runs so that padding between
+	//! members is never touched; types with a handler (such as a codec for std::string) are left to it; and members
+	//! accessed through getter and setter functions go through the Member. A value that fits none of these is not
+	//! skipped: it makes the plan incomplete, and the owner refuses to use it.
+	//! \param Handler What the owner uses for types that cannot be treated as bytes, e.g. Serializer::Codec.
+	template <typename Handler> class FieldPlan
+	{
+	public:
+		//! \brief One step of a plan.
+		struct Step
+		{
+			enum Kind
+			{
+				Bytes, //!< The size bytes at offset.
+				Field, //!< The field at offset of type, with its handler.
+				Property, //!< The member of the owner at offset, through Member::Get and Member::Set.
+			};
+
+			Kind kind; //!< What to visit.
+			ptrdiff_t offset; //!< Offset of the data or member owner from the start of the object.
+			size_t size; //!< Size of the data in bytes.
+			const TypeInfo* type; //!< Type of the field or property value.
+			const Handler* handler; //!< Handler of a Field.
+			const Member* member; //!< Member of a Property.
+			const TypeInfo* owner; //!< Owner type of a Property.
+		};
+
+	private:
+		std::vector<Step> m_Steps; //!< Fields ordered by offset, then properties in member order.
+		const TypeInfo* m_Unsupported; //!< The first type found that no step can handle, or nullptr.
+
+		//! \brief Adds the steps for a value of a type at an offset.
+		template <typename Handlers> void Add(const TypeInfo* type, ptrdiff_t offset, const Handlers& handlers, bool settable)
+		{
+			auto h = handlers.find(type);
+			if (h != handlers.end())
+			{
+				Step s = { Step::Field, offset, type->GetSize(), type, &h->second, nullptr, nullptr };
+				m_Steps.push_back(s);
+			}
+			else if (!type->GetBases().empty() || !type->GetMembers().empty())
+			{
+				for (auto& e : type->GetAllMembers())
+				{
+					auto m = e.item;
+					auto mt = m->GetType();
+					if (mt == nullptr)
+						continue;
+
+					if (m->IsField())
+						Add(mt, offset + e.offset + m->GetOffset(), handlers, settable);
+					else if (!settable || (m->IsMutable() && mt->CanConstruct()))
+					{
+						Step s = { Step::Property, offset + e.offset, 0, mt, nullptr, m, m->GetOwner() };
+						m_Steps.push_back(s);
+					}
+				}
+			}
+			else if (type->IsTriviallyCopyable())
+			{
+				Step s = { Step::Bytes, offset, type->GetSize(), type, nullptr, nullptr, nullptr };
+				m_Steps.push_back(s);
+			}
+			else if (m_Unsupported == nullptr)
+			{
+				m_Unsupported = type;
+			}
+		}
+
+		//! \brief Orders the field steps by offset and merges adjacent byte ranges; properties keep their order at the end.
+		void Optimize()
+		{
+			auto properties = std::stable_partition(m_Steps.begin(), m_Steps.end(), [](const Step& s) { return s.kind != Step::Property; });
+			std::stable_sort(m_Steps.begin(), properties, [](const Step& a, const Step& b) { return a.offset < b.offset; });
+
+			std::vector<Step> merged;
+			merged.reserve(m_Steps.size());
+			for (auto& s : m_Steps)
+			{
+				if (s.kind == Step::Bytes && !merged.empty() && merged.back().kind == Step::Bytes && merged.back().offset + static_cast<ptrdiff_t>(merged.back().size) == s.offset)
+					merged.back().size += s.size;
+				else
+					merged.push_back(s);
+			}
+			m_Steps.swap(merged);
+		}
+
+	public:
+		FieldPlan() : m_Unsupported(nullptr) { }
+
+		//! \brief Compiles the plan for a type.
+		//! \param handlers A map from types to handlers, which must outlive the plan.
+		//! \param settable Whether to leave out members accessed through functions that cannot be set from a default
+		//! constructed value, e.g. when loading; such members are computed from others rather than state of their own.
+		template <typename Handlers> static FieldPlan Compile(const TypeInfo* type, const Handlers& handlers, bool settable)
+		{
+			FieldPlan plan;
+			plan.Add(type, 0, handlers, settable);
+			plan.Optimize();
+			return plan;
+		}
+
+		//! \brief Checks that the plan covers every value of the type.
+		bool IsComplete() const { return m_Unsupported == nullptr; }
+
+		//! \brief Retrieves the first type found with no handler, no reflected members and no trivial copy, or nullptr if the plan is complete.
+		const TypeInfo* GetUnsupported() const { return m_Unsupported; }
+
+		typename std::vector<Step>::const_iterator begin() const { return m_Steps.begin(); }
+		typename std::vector<Step>::const_iterator end() const { return m_Steps.end(); }
+		size_t size() const { return m_Steps.size(); }
+		const Step& operator[](size_t index) const { return m_Steps[index]; }
+	};
+
+	//! \brief A base type in a StaticTypeInfo.
+	struct StaticBase
+	{
+		const StaticTypeInfo* type; //!< The base type
+		void* (*upcast)(void*); //!< Converts a pointer to the deriving type into a pointer to this base
+
+		//! \brief Offset that must be applied to convert a pointer from the deriving type to this base.
+		ptrdiff_t GetOffset() const { return static_cast<char*>(upcast(reinterpret_cast<void*>(0x1000))) - reinterpret_cast<char*>(0x1000); }
+	};
+
+	//! \brief A plain data member in a StaticTypeInfo.
+	struct StaticField
+	{
+		const char* name; //!< The name of the variable
+		size_t hash; //!< Hash of the name
+		const TypeInfo* (*type)(); //!< Meta::Get for the type of the variable
+		void* (*address)(void*); //!< Converts a pointer to the owner into a pointer to the variable
+		size_t size; //!< Size of the variable in bytes
+
+		//! \brief Offset of the variable within the owner.
+		ptrdiff_t GetOffset() const { return static_cast<char*>(address(reinterpret_cast<void*>(0x1000))) - reinterpret_cast<char*>(0x1000); }
+	};
+
+	//! \brief A method in a StaticTypeInfo.
+	struct StaticMethod
+	{
+		const char* name; //!< The name of the method
+		size_t hash; //!< Hash of the name
+		const void* (*signature)(); //!< Identity of the exact return and parameter types, from internal::signature
+		void (*call)(void* obj, void* ret, void* const* argv); //!< Calls the method with pointers to native arguments, constructing the return value (if any) in ret
+		int arity; //!< Number of parameters
+
+		//! \brief Tests if the method can be invoked with exactly the given return and parameter types.
+		template <typename ReturnType, typename... ParamTypes> bool CanInvoke() const { return signature() == internal::signature<ReturnType, ParamTypes...>::id(); }
+
+		//! \brief Invoke the method directly with native arguments.  The types must match the method exactly; check with CanInvoke.
+		//! \param obj An instance of the owner type, already adjusted from any derived type.
+		//! \param args The arguments to pass to the method.
+		template <typename ReturnType, typename... ParamTypes> ReturnType Invoke(void* obj, ParamTypes... args) const
+		{
+			assert((CanInvoke<ReturnType, ParamTypes...>()) && "Invoke types do not match the method");
+			void* const argv[] = { const_cast<void*>(static_cast<const void*>(&args))..., nullptr };
+			return internal::static_return<ReturnType>::invoke(call, obj, argv);
+		}
+	};
+
+	//! \brief A counted view of one of the constant tables of a StaticTypeInfo.
+	template <typename Item> struct StaticList
+	{
+		const Item* items; //!< The first item, or nullptr if there are none
+		size_t count; //!< The number of items
+
+		constexpr StaticList() : items(nullptr), count(0) { }
+		template <size_t Count> constexpr StaticList(const Item (&list)[Count]) : items(list), count(Count) { }
+
+		const Item* begin() const { return items; }
+		const Item* end() const { return items + count; }
+	};
+
+	//! \brief Describes a type entirely with constant tables, defined by META_DEFINE_STATIC.
+	//! The tables are constant-initialized by the compiler into read-only data, so they need no work at startup
+	//! and can be used from any dynamic initializer regardless of the order in which translation units are initialized.
+	struct StaticTypeInfo
+	{
+		const char* name; //!< The name of the type, as written in META_DEFINE_STATIC
+		size_t size; //!< Size of the type in bytes
+		StaticList<StaticBase> bases; //!< The direct base types
+		StaticList<StaticField> fields; //!< The plain data members
+		StaticList<StaticMethod> methods; //!< The methods
+
+		//! \brief Tests is this type is derived from another type or is the same type.
+		bool IsSameOrDerivedFrom(const StaticTypeInfo* base) const
+		{
+			if (base == this)
+				return true;
+			for (auto& b : bases)
+				if (b.type->IsSameOrDerivedFrom(base))
+					return true;
+			return false;
+		}
+
+		//! \brief Adjust a pointer of this type to a base type.
+		//! \returns The adjusted pointer, or nullptr if the given type is not this type or one of its bases.
+		void* Adjust(const StaticTypeInfo* base, void* ptr) const
+		{
+			if (base == this)
+				return ptr;
+			for (auto& b : bases)
+				if (void* adjusted = b.type->Adjust(base, b.upcast(ptr)))
+					return adjusted;
+			return nullptr;
+		}
+
+		//! \brief Find a plain data member of this type or any base type.
+		//! \param name The name of the member to look up.
+		//! \param offset Receives the offset from this type to the member's owner.
+		//! \returns The field or nullptr if no such member exists.
+		const StaticField* FindField(const char* name, ptrdiff_t& offset) const { return Find(&StaticTypeInfo::fields, name, internal::hash_name(name), offset); }
+
+		//! \brief Resolve a plain data member of this type or any base type to a direct access handle.
+		//! \returns A handle for instances of this type, or an invalid handle if the member does not exist or is not of type Type.
+		template <typename Type> TypedField<Type> FindField(const char* name) const
+		{
+			ptrdiff_t offset;
+			auto f = FindField(name, offset);
+			if (f == nullptr || f->type != static_cast<const TypeInfo* (*)()>(&Meta::Get<Type>))
+				return TypedField<Type>();
+			return TypedField<Type>(offset + f->GetOffset());
+		}
+
+		//! \brief Find a method of this type or any base type.
+		//! \param name The name of the method to look up.
+		//! \param offset Receives the offset from this type to the method's owner.
+		//! \returns The method or nullptr if no such method exists.
+		const StaticMethod* FindMethod(const char* name, ptrdiff_t& offset) const { return Find(&StaticTypeInfo::methods, name, internal::hash_name(name), offset); }
+
+	private:
+		//! \brief Searches one of the tables of this type, then of each base in turn; the first match wins.
+		template <typename Item> const Item* Find(StaticList<Item> StaticTypeInfo::*list, const char* name, size_t hash, ptrdiff_t& offset) const
+		{
+			for (auto& i : this->*list)
+			{
+				if (i.hash == hash && std::strcmp(i.name, name) == 0)
+				{
+					offset = 0;
+					return &i;
+				}
+			}
+			for (auto& b : bases)
+			{
+				if (auto i = b.type->Find(list, name, hash, offset))
+				{
+					offset += b.GetOffset();
+					return i;
+				}
+			}
+			return nullptr;
+		}
+	};
+
+	namespace internal
+	{
+		//! \brief Holder for the StaticTypeInfo of a type, defined by META_DEFINE_STATIC.
+		template <typename Type> struct StaticHolder
+		{
+			static const StaticTypeInfo s_TypeInfo;
+		};
+
+		//! \brief Converts a pointer to a deriving type into a pointer to a base, for StaticBase.
+		template <typename Type, typename BaseType> void* static_upcast(void* ptr) { return static_cast<BaseType*>(static_cast<Type*>(ptr)); }
+
+		//! \brief The thunk behind StaticField::address, for a data member of Type or one of its bases.  Unlike offsetof,
+		//! this is valid for types that are not standard-layout, such as those with bases or virtual functions.
+		template <typename Type, typename Member, Member member> void* static_field(void* ptr) { return &(static_cast<Type*>(ptr)->*member); }
+
+		//! \brief The thunk behind StaticMethod::call, for a member function known at compile time.
+		template <typename Function, Function function> struct static_method;
+
+		template <typename Type, typename ReturnType, typename... ParamTypes, ReturnType (Type::*function)(ParamTypes...)> struct static_method<ReturnType (Type::*)(ParamTypes...), function>
+		{
+			static const int arity = static_cast<int>(sizeof...(ParamTypes));
+
+			static const void* signature() { return internal::signature<ReturnType, ParamTypes...>::id(); }
+
+			static void call(void* obj, void* ret, void* const* argv) { call(static_cast<Type*>(obj), ret, argv, std::index_sequence_for<ParamTypes...>(), std::is_void<ReturnType>()); }
+
+			template <size_t... Indices> static void call(Type* obj, void* ret, void* const* argv, std::index_sequence<Indices...>, std::false_type)
+			{
+				static_return<ReturnType>::store(ret, (obj->*function)(std::forward<ParamTypes>(*static_cast<typename std::remove_reference<ParamTypes>::type*>(argv[Indices]))...));
+			}
+
+			template <size_t... Indices> static void call(Type* obj, void*, void* const* argv, std::index_sequence<Indices...>, std::true_type)
+			{
+				(obj->*function)(std::forward<ParamTypes>(*static_cast<typename std::remove_reference<ParamTypes>::type*>(argv[Indices]))...);
+			}
 		};
 	}
+
+	/*! \brief Get the StaticTypeInfo for a type defined with META_DEFINE_STATIC. */
+	template <typename Type> const StaticTypeInfo* GetStatic() { return &internal::StaticHolder<Type>::s_TypeInfo; }
 }
 
 //! \brief Add to a type declaration to make it participate in polymorphic type lookups and to allow binding private members and methods.
@@ -810,4 +2496,38 @@ namespace Meta
 
 //! \brief Put outside of any declaration to begin annotating a type marked up with META_DECLARE(T)
 //! \param T The type to annotate.
-#define META_DEFINE(T) const ::Meta::TypeInfo T::MetaStaticHolder::s_TypeInfo = ::Meta::internal::TypedInfo<T, true>(#T)
\ No newline at end of file
+#define META_DEFINE(T) const ::Meta::TypeInfo T::MetaStaticHolder::s_TypeInfo = ::Meta::internal::TypedInfo<T, true>(#T)
+
+//! \brief Put outside of any declaration to describe a type with constant tables rather than a TypeInfo built at startup.
+//! \param T The type to describe.
+//! Declare the arrays constexpr, so that an entry that cannot be constant-initialized fails to compile:
+//! static constexpr Meta::StaticField s_BodyFields[] = { META_STATIC_FIELD(Body, mass) };
+//! \param bases An array of META_STATIC_BASE entries, or {} for none.
+//! \param fields An array of META_STATIC_FIELD entries, or {} for none.
+//! \param methods An array of META_STATIC_METHOD entries, or {} for none.
+#define META_DEFINE_STATIC(T, bases, fields, methods) template<> const ::Meta::StaticTypeInfo Meta::internal::StaticHolder<T>::s_TypeInfo = { #T, sizeof(T), bases, fields, methods }
+
+//! \brief An entry for the bases array of META_DEFINE_STATIC.  The base must also be defined with META_DEFINE_STATIC.
+//! \param T The type being described.
+//! \param B The base type.
+#define META_STATIC_BASE(T, B) { &::Meta::internal::StaticHolder<B>::s_TypeInfo, &::Meta::internal::static_upcast<T, B> }
+
+//! \brief An entry for the fields array of META_DEFINE_STATIC.
+//! \param T The type being described.
+//! \param name The name of a public data member.
+#define META_STATIC_FIELD(T, name) { #name, ::Meta::internal::hash_name_constant(#name), static_cast<const ::Meta::TypeInfo* (*)()>(&::Meta::Get<decltype(T::name)>), &::Meta::internal::static_field<T, decltype(&T::name), &T::name>, sizeof(T::name) }
+
+//! \brief An entry for the methods array of META_DEFINE_STATIC.
+//! \param T The type being described.
+//! \param name The name of a public, non-overloaded member function.
+#define META_STATIC_METHOD(T, name) { #name, ::Meta::internal::hash_name_constant(#name), &::Meta::internal::static_method<decltype(&T::name), &T::name>::signature, &::Meta::internal::static_method<decltype(&T::name), &T::name>::call, ::Meta::internal::static_method<decltype(&T::name), &T::name>::arity }
+
+//! \brief Marks a class or struct for MetaGen, which writes its definition into a generated source file.
+//! Put before the class key: META_TYPE struct Monster : Actor { ... };
+#define META_TYPE
+
+//! \brief Marks a data member of a META_TYPE for MetaGen.  Put before the declaration.
+#define META_FIELD
+
+//! \brief Marks a non-const, non-overloaded member function of a META_TYPE for MetaGen.  Put before the declaration.
+#define META_METHOD
\ No newline at end of file
@@ -0,0 +1,768 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+// MetaGen reads headers annotated with META_TYPE, META_FIELD and META_METHOD and writes the definitions of the
+// annotated types into a single source file, either as META_DEFINE chains or as META_DEFINE_STATIC constant tables.
+// The templates behind the definitions are then instantiated in that one translation unit rather than wherever the
+// definitions are written by hand, and the constant tables avoid the TypedInfo, TypeMember and TypedMethod templates
+// altogether.  The headers are scanned for the annotations, not compiled, so the tool needs no compiler front end.
+//
+//   MetaGen [-static] -o Output.cpp Header.h...
+//   MetaGen -bench Count "compiler command"
+//
+// The second form measures how long the compiler takes to build the definitions of Count synthetic types each way.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	//! \brief A token of a header and the line it starts on.
+	struct Token
+	{
+		std::string text;
+		int line;
+	};
+
+	//! \brief An annotated field or method.
+	struct Item
+	{
+		std::string name; //!< The name of the member.
+		bool isPublic; //!< Whether the member is accessible outside of the type.
+		int line; //!< Line of the annotation.
+	};
+
+	//! \brief An annotated type.
+	struct Type
+	{
+		std::string name; //!< The qualified name.
+		std::string scope; //!< The qualified name of the enclosing namespace or type, used to resolve bases.
+		std::string file; //!< The header declaring the type.
+		int line; //!< Line of the annotation.
+		bool declared; //!< Whether the type uses META_DECLARE, which lets META_DEFINE bind private members.
+		std::vector<std::string> bases; //!< The public bases, as written.
+		std::vector<std::string> uses; //!< The types of the fields, as written, to order definitions.
+		std::vector<Item> fields; //!< The annotated fields.
+		std::vector<Item> methods; //!< The annotated methods.
+	};
+
+	bool IsIdentifier(const std::string& text) { return !text.empty() && (std::isalpha(static_cast<unsigned char>(text[0])) || text[0] == '_'); }
+
+	//! \brief Splits a header into identifiers, numbers, literals, :: and single punctuation characters.
+	//! Comments and preprocessor directives are skipped.
+	bool Tokenize(const std::string& path, std::vector<Token>& tokens)
+	{
+		std::ifstream in(path.c_str(), std::ios::binary);
+		if (!in)
+			return false;
+		std::stringstream buffer;
+		buffer << in.rdbuf();
+		const std::string source = buffer.str();
+
+		const size_t size = source.size();
+		int line = 1;
+		bool lineStart = true;
+		for (size_t i = 0; i < size; )
+		{
+			const char c = source[i];
+			if (c == '\n')
+			{
+				++line;
+				++i;
+				lineStart = true;
+			}
+			else if (std::isspace(static_cast<unsigned char>(c)))
+				++i;
+			else if (c == '/' && i + 1 < size && source[i + 1] == '/')
+			{
+				while (i < size && source[i] != '\n')
+					++i;
+			}
+			else if (c == '/' && i + 1 < size && source[i + 1] == '*')
+			{
+				for (i += 2; i < size && !(source[i] == '*' && i + 1 < size && source[i + 1] == '/'); ++i)
+					line += source[i] == '\n';
+				i += 2;
+			}
+			else if (c == '#' && lineStart)
+			{
+				// a directive ends at a newline that is not escaped
+				for (; i < size && source[i] != '\n'; ++i)
+				{
+					if (source[i] == '\\' && i + 1 < size && source[i + 1] == '\n')
+					{
+						++i;
+						++line;
+					}
+				}
+			}
+			else
+			{
+				lineStart = false;
+				const size_t start = i;
+				if (std::isalnum(static_cast<unsigned char>(c)) || c == '_')
+				{
+					while (i < size && (std::isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_'))
+						++i;
+				}
+				else if (c == '"' || c == '\'')
+				{
+					for (++i; i < size && source[i] != c && source[i] != '\n'; ++i)
+						if (source[i] == '\\')
+							++i;
+					++i;
+				}
+				else if (c == ':' && i + 1 < size && source[i + 1] == ':')
+					i += 2;
+				else
+					++i;
+
+				Token t = { source.substr(start, i - start), line };
+				tokens.push_back(t);
+			}
+		}
+		return true;
+	}
+
+	//! \brief Finds the annotated types in headers.
+	class Parser
+	{
+		//! \brief A namespace, class or block that a closing brace ends.
+		struct Scope
+		{
+			std::string name; //!< The name, or empty for blocks and anonymous namespaces.
+			int type; //!< Index of the annotated type, or -1.
+			bool isClass; //!< Whether access specifiers apply.
+			bool isPublic; //!< The current access of a class.
+		};
+
+		std::vector<Type> m_Types;
+		std::vector<Scope> m_Scopes;
+		std::vector<Token> m_Tokens;
+		std::string m_File;
+		int m_Errors;
+
+		void Error(int line, const char* message, const std::string& detail = std::string())
+		{
+			std::fprintf(stderr, "%s(%d): error: %s%s\n", m_File.c_str(), line, message, detail.c_str());
+			++m_Errors;
+		}
+
+		const std::string& Text(size_t i) const
+		{
+			static const std::string s_End;
+			return i < m_Tokens.size() ? m_Tokens[i].text : s_End;
+		}
+
+		int Line(size_t i) const { return i < m_Tokens.size() ? m_Tokens[i].line : (m_Tokens.empty() ? 0 : m_Tokens.back().line); }
+
+		std::string Qualify(const std::string& name) const
+		{
+			std::string qualified;
+			for (auto& s : m_Scopes)
+				if (!s.name.empty())
+					qualified += s.name + "::";
+			return qualified + name;
+		}
+
+		//! \brief Joins tokens into a name, spacing only between adjacent identifiers.
+		static std::string Join(const std::vector<std::string>& words)
+		{
+			std::string joined;
+			for (auto& w : words)
+			{
+				if (!joined.empty() && IsIdentifier(w) && (std::isalnum(static_cast<unsigned char>(joined.back())) || joined.back() == '_'))
+					joined += ' ';
+				joined += w;
+			}
+			return joined;
+		}
+
+		//! \brief Reads a class head from the class key up to its opening brace.
+		//! \returns The index after the brace, or the index of the terminating token if this is not a definition.
+		size_t ParseClass(size_t i, bool annotated)
+		{
+			const bool isStruct = Text(i) != "class";
+			const std::string name = Text(i + 1);
+			size_t j = i + 2;
+
+			// skip to the brace, stopping at anything that shows this is a declaration or template parameter
+			std::vector<std::string> bases;
+			if (Text(j) == ":")
+			{
+				std::vector<std::string> words;
+				bool isPublic = isStruct;
+				int angle = 0;
+				for (++j; j < m_Tokens.size() && Text(j) != "{" && Text(j) != ";"; ++j)
+				{
+					const std::string& t = Text(j);
+					if (angle == 0 && t == ",")
+					{
+						if (isPublic && !words.empty())
+							bases.push_back(Join(words));
+						words.clear();
+						isPublic = isStruct;
+						continue;
+					}
+					angle += t == "<" ? 1 : t == ">" ? -1 : 0;
+					if (angle == 0 && (t == "public" || t == "protected" || t == "private"))
+						isPublic = t == "public";
+					else if (angle != 0 || t != "virtual")
+						words.push_back(t);
+				}
+				if (isPublic && !words.empty())
+					bases.push_back(Join(words));
+			}
+			else
+			{
+				while (j < m_Tokens.size() && Text(j) != "{" && Text(j) != ";" && Text(j) != "(" && Text(j) != ")" && Text(j) != "=" && Text(j) != "," && Text(j) != ">")
+					++j;
+			}
+
+			if (Text(j) != "{")
+			{
+				if (annotated)
+					Error(Line(i), "META_TYPE must annotate a class definition");
+				return j;
+			}
+
+			Scope scope = { name, -1, true, isStruct };
+			if (annotated)
+			{
+				Type type;
+				type.name = Qualify(name);
+				type.scope = Qualify(std::string());
+				if (type.scope.size() >= 2)
+					type.scope.resize(type.scope.size() - 2);
+				type.file = m_File;
+				type.line = Line(i);
+				type.declared = false;
+				type.bases = bases;
+				scope.type = static_cast<int>(m_Types.size());
+				m_Types.push_back(type);
+			}
+			m_Scopes.push_back(scope);
+			return j + 1;
+		}
+
+		//! \brief Reads the declaration following META_FIELD.
+		//! \returns The index after its semicolon.
+		size_t ParseField(size_t i, Type& type, bool isPublic)
+		{
+			const int line = Line(i);
+			std::vector<std::vector<std::string>> declarators(1);
+			int depth = 0, angle = 0;
+			bool initializer = false;
+			size_t j = i + 1;
+			for (; j < m_Tokens.size(); ++j)
+			{
+				const std::string& t = Text(j);
+				if (depth == 0 && t == ";")
+					break;
+				if (t == "(" || t == "[" || t == "{")
+					++depth;
+				else if (t == ")" || t == "]" || t == "}")
+					--depth;
+				else if (depth == 0 && !initializer && t == "<")
+					++angle;
+				else if (depth == 0 && !initializer && t == ">")
+					--angle;
+				else if (depth == 0 && angle == 0 && t == ",")
+				{
+					declarators.push_back(std::vector<std::string>());
+					initializer = false;
+					continue;
+				}
+				if (depth == 0 && angle == 0 && (t == "=" || t == ":"))
+					initializer = true;
+				if (!initializer && (depth == 0 || (depth == 1 && t == "{")))
+					declarators.back().push_back(t);
+			}
+
+			auto& first = declarators.front();
+			if (std::find(first.begin(), first.end(), "static") != first.end())
+			{
+				Error(line, "META_FIELD cannot annotate a static member");
+				return j + 1;
+			}
+
+			for (auto& d : declarators)
+			{
+				// the name is the last identifier before a brace initializer or array bound
+				auto end = std::find_if(d.begin(), d.end(), [](const std::string& w) { return w == "{" || w == "["; });
+				auto name = std::find_if(std::reverse_iterator<decltype(end)>(end), d.rend(), [](const std::string& w) { return IsIdentifier(w) && w != "const" && w != "volatile"; });
+				if (name == d.rend())
+				{
+					Error(line, "META_FIELD must annotate a data member declaration");
+					continue;
+				}
+				Item item = { *name, isPublic, line };
+				type.fields.push_back(item);
+
+				// the type of the first declarator, less qualifiers, orders the definition after the type it uses
+				if (&d == &first)
+				{
+					std::vector<std::string> words;
+					for (auto w = d.begin(); w != name.base() - 1; ++w)
+						if (*w != "const" && *w != "mutable" && *w != "volatile")
+							words.push_back(*w);
+					if (!words.empty())
+						type.uses.push_back(Join(words));
+				}
+			}
+			return j + 1;
+		}
+
+		//! \brief Reads the declaration following META_METHOD up to its parameter list.
+		//! \returns The index of the opening parenthesis, so the body is scanned as an ordinary block.
+		size_t ParseMethod(size_t i, Type& type, bool isPublic)
+		{
+			const int line = Line(i);
+			size_t j = i + 1;
+			std::string name;
+			bool isStatic = false;
+			int angle = 0;
+			for (; j < m_Tokens.size() && (angle != 0 || Text(j) != "(") && Text(j) != ";" && Text(j) != "{"; ++j)
+			{
+				const std::string& t = Text(j);
+				angle += t == "<" ? 1 : t == ">" ? -1 : 0;
+				if (angle == 0 && IsIdentifier(t))
+					name = t;
+				isStatic = isStatic || t == "static";
+			}
+
+			if (Text(j) != "(" || name.empty())
+			{
+				Error(line, "META_METHOD must annotate a member function declaration");
+				return j;
+			}
+			if (isStatic || name == "operator" || Text(j - 2) == "operator")
+			{
+				Error(line, "META_METHOD cannot annotate a static member function or an operator: ", name);
+				return j;
+			}
+
+			// a const qualifier follows the parameter list, before the body or semicolon
+			int depth = 0;
+			for (size_t k = j; k < m_Tokens.size(); ++k)
+			{
+				const std::string& t = Text(k);
+				depth += t == "(" ? 1 : t == ")" ? -1 : 0;
+				if (depth == 0 && (t == "{" || t == ";" || t == "="))
+					break;
+				if (depth == 0 && t == "const")
+				{
+					Error(line, "META_METHOD cannot annotate a const member function: ", name);
+					return j;
+				}
+			}
+
+			Item item = { name, isPublic, line };
+			type.methods.push_back(item);
+			return j;
+		}
+
+	public:
+		Parser() : m_Errors(0) { }
+
+		const std::vector<Type>& GetTypes() const { return m_Types; }
+		int GetErrors() const { return m_Errors; }
+
+		//! \brief Adds the annotated types of a header.
+		bool Parse(const std::string& path)
+		{
+			m_File = path;
+			m_Tokens.clear();
+			m_Scopes.clear();
+			if (!Tokenize(path, m_Tokens))
+			{
+				std::fprintf(stderr, "%s: error: cannot read the file\n", path.c_str());
+				++m_Errors;
+				return false;
+			}
+
+			const int errors = m_Errors;
+			for (size_t i = 0; i < m_Tokens.size(); )
+			{
+				const std::string& t = Text(i);
+				Scope* top = m_Scopes.empty() ? nullptr : &m_Scopes.back();
+				Type* type = top != nullptr && top->type >= 0 ? &m_Types[top->type] : nullptr;
+
+				if (t == "namespace")
+				{
+					std::vector<std::string> words;
+					size_t j = i + 1;
+					for (; j < m_Tokens.size() && Text(j) != "{" && Text(j) != ";" && Text(j) != "="; ++j)
+						words.push_back(Text(j));
+					if (Text(j) == "{")
+					{
+						Scope scope = { Join(words), -1, false, true };
+						m_Scopes.push_back(scope);
+					}
+					i = j + 1;
+				}
+				else if (t == "META_TYPE")
+				{
+					if (Text(i + 1) != "struct" && Text(i + 1) != "class")
+					{
+						Error(Line(i), "META_TYPE must be followed by struct or class");
+						++i;
+					}
+					else
+						i = ParseClass(i + 1, true);
+				}
+				else if ((t == "struct" || t == "class" || t == "union") && IsIdentifier(Text(i + 1)) && Text(i - 1) != "enum")
+					i = ParseClass(i, false);
+				else if (t == "META_FIELD" || t == "META_METHOD")
+				{
+					if (type == nullptr)
+					{
+						Error(Line(i), "member annotations must be directly inside a META_TYPE");
+						++i;
+					}
+					else if (t == "META_FIELD")
+						i = ParseField(i, *type, top->isPublic);
+					else
+						i = ParseMethod(i, *type, top->isPublic);
+				}
+				else if (t == "META_DECLARE" && type != nullptr)
+				{
+					// META_DECLARE ends in a public access specifier
+					type->declared = true;
+					top->isPublic = true;
+					++i;
+				}
+				else if ((t == "public" || t == "protected" || t == "private") && Text(i + 1) == ":" && top != nullptr && top->isClass)
+				{
+					top->isPublic = t == "public";
+					i += 2;
+				}
+				else if (t == "{")
+				{
+					Scope scope = { std::string(), -1, false, true };
+					m_Scopes.push_back(scope);
+					++i;
+				}
+				else if (t == "}")
+				{
+					if (!m_Scopes.empty())
+						m_Scopes.pop_back();
+					++i;
+				}
+				else
+					++i;
+			}
+			return m_Errors == errors;
+		}
+
+		//! \brief Finds the annotated type a name refers to from a scope, searching the scope and then each enclosing one.
+		//! \returns The index of the type, or -1 if the name is not an annotated type.
+		int Resolve(const std::string& name, std::string scope) const
+		{
+			const std::string unqualified = name.compare(0, 2, "::") == 0 ? name.substr(2) : name;
+			for (;;)
+			{
+				const std::string candidate = scope.empty() ? unqualified : scope + "::" + unqualified;
+				for (size_t i = 0; i != m_Types.size(); ++i)
+					if (m_Types[i].name == candidate)
+						return static_cast<int>(i);
+				if (scope.empty() || name.compare(0, 2, "::") == 0)
+					return -1;
+				const size_t colons = scope.rfind("::");
+				scope = colons == std::string::npos ? std::string() : scope.substr(0, colons);
+			}
+		}
+	};
+
+	//! \brief Orders the types so that each follows the annotated types it derives from or stores, as the static tables require.
+	void Order(const Parser& parser, int index, std::vector<int>& state, std::vector<int>& order)
+	{
+		if (state[index] != 0)
+			return;
+		state[index] = 1;
+		const Type& type = parser.GetTypes()[index];
+		for (auto& b : type.bases)
+		{
+			const int base = parser.Resolve(b, type.scope);
+			if (base >= 0)
+				Order(parser, base, state, order);
+		}
+		for (auto& u : type.uses)
+		{
+			const int used = parser.Resolve(u, type.scope);
+			if (used >= 0 && used != index)
+				Order(parser, used, state, order);
+		}
+		state[index] = 2;
+		order.push_back(index);
+	}
+
+	//! \brief Writes the definitions of the annotated types.
+	//! \param tables Whether to write META_DEFINE_STATIC tables rather than META_DEFINE chains.
+	//! \returns False if a member cannot be bound from the generated file.
+	bool Generate(const Parser& parser, const std::vector<std::string>& headers, bool tables, std::ostream& out)
+	{
+		out << "// Generated by MetaGen from";
+		for (auto& h : headers)
+			out << ' ' << h;
+		out << ".  Do not edit; regenerate instead.\n\n#include \"Meta.h\"\n";
+		for (auto& h : headers)
+			out << "#include \"" << h << "\"\n";
+
+		const std::vector<Type>& types = parser.GetTypes();
+		std::vector<int> state(types.size()), order;
+		for (size_t i = 0; i != types.size(); ++i)
+			Order(parser, static_cast<int>(i), state, order);
+
+		bool ok = true;
+		for (int index : order)
+		{
+			const Type& type = types[index];
+
+			// META_DEFINE is written in the scope of the type, so only it can bind private members
+			const bool privileged = type.declared && !tables;
+			std::vector<const Item*> items;
+			for (auto& f : type.fields)
+				items.push_back(&f);
+			for (auto& m : type.methods)
+				items.push_back(&m);
+			for (auto item : items)
+			{
+				if (!item->isPublic && !privileged)
+				{
+					std::fprintf(stderr, "%s(%d): error: %s::%s is not public%s\n", type.file.c_str(), item->line, type.name.c_str(), item->name.c_str(), tables ? "" : " and the type does not use META_DECLARE");
+					ok = false;
+				}
+			}
+
+			std::vector<std::string> bases;
+			for (auto& b : type.bases)
+			{
+				const int base = parser.Resolve(b, type.scope);
+				if (base >= 0)
+					bases.push_back(types[base].name);
+				else
+					std::fprintf(stderr, "%s(%d): warning: base %s of %s is not a META_TYPE and is left out\n", type.file.c_str(), type.line, b.c_str(), type.name.c_str());
+			}
+
+			out << '\n';
+			if (tables)
+			{
+				std::string id = type.name;
+				for (size_t colons; (colons = id.find("::")) != std::string::npos; )
+					id.replace(colons, 2, "_");
+
+				std::string list[3] = { "{}", "{}", "{}" };
+				if (!bases.empty())
+				{
+					list[0] = "s_" + id + "Bases";
+					out << "static constexpr Meta::StaticBase " << list[0] << "[] = {";
+					for (size_t i = 0; i != bases.size(); ++i)
+						out << (i == 0 ? " " : ", ") << "META_STATIC_BASE(" << type.name << ", " << bases[i] << ")";
+					out << " };\n";
+				}
+				if (!type.fields.empty())
+				{
+					list[1] = "s_" + id + "Fields";
+					out << "static constexpr Meta::StaticField " << list[1] << "[] = {";
+					for (size_t i = 0; i != type.fields.size(); ++i)
+						out << (i == 0 ? " " : ", ") << "META_STATIC_FIELD(" << type.name << ", " << type.fields[i].name << ")";
+					out << " };\n";
+				}
+				if (!type.methods.empty())
+				{
+					list[2] = "s_" + id + "Methods";
+					out << "static constexpr Meta::StaticMethod " << list[2] << "[] = {";
+					for (size_t i = 0; i != type.methods.size(); ++i)
+						out << (i == 0 ? " " : ", ") << "META_STATIC_METHOD(" << type.name << ", " << type.methods[i].name << ")";
+					out << " };\n";
+				}
+				out << "META_DEFINE_STATIC(" << type.name << ", " << list[0] << ", " << list[1] << ", " << list[2] << ");\n";
+			}
+			else
+			{
+				out << (type.declared ? "META_DEFINE(" : "META_DEFINE_EXTERN(") << type.name << ")";
+				for (auto& b : bases)
+					out << "\n\t.base<" << b << ">()";
+				for (auto& f : type.fields)
+					out << "\n\t.member(\"" << f.name << "\", &" << type.name << "::" << f.name << ")";
+				for (auto& m : type.methods)
+					out << "\n\t.method(\"" << m.name << "\", &" << type.name << "::" << m.name << ")";
+				out << ";\n";
+			}
+		}
+		return ok;
+	}
+
+	//! \brief Parses headers and writes the generated file only if its contents changed, so dependent builds stay up to date.
+	int Run(const std::vector<std::string>& headers, const std::string& output, bool tables)
+	{
+		Parser parser;
+		for (auto& h : headers)
+			parser.Parse(h);
+		if (parser.GetErrors() != 0)
+			return 1;
+
+		std::ostringstream generated;
+		if (!Generate(parser, headers, tables, generated))
+			return 1;
+
+		std::ifstream existing(output.c_str(), std::ios::binary);
+		std::stringstream previous;
+		previous << existing.rdbuf();
+		if (existing && previous.str() == generated.str())
+			return 0;
+		existing.close();
+
+		std::ofstream out(output.c_str(), std::ios::binary);
+		out << generated.str();
+		if (!out)
+		{
+			std::fprintf(stderr, "%s: error: cannot write the file\n", output.c_str());
+			return 1;
+		}
+		return 0;
+	}
+
+	//! \brief Writes a header of synthetic annotated types for the build benchmark.  Every odd type derives from the one before it.
+	void Synthesize(std::ostream& out, int count)
+	{
+		out << "// Synthetic types for the MetaGen build benchmark.\n\n#pragma once\n\n#include \"Meta.h\"\n\nnamespace MetaGenBench\n{\n";
+		for (int i = 0; i != count; ++i)
+		{
+			out << "\tMETA_TYPE struct Type" << i;
+			if (i % 2 == 1)
+				out << " : Type" << i - 1;
+			out << "\n\t{\n";
+			out << "\t\tMETA_FIELD int i" << i << ";\n";
+			out << "\t\tMETA_FIELD float f" << i << ";\n";
+			out << "\t\tMETA_FIELD double d" << i << ";\n";
+			out << "\t\tMETA_FIELD char c" << i << ";\n";
+			out << "\t\tMETA_FIELD float x" << i << ", y" << i << ";\n\n";
+			out << "\t\tMETA_METHOD float scale" << i << "(float s) { return f" << i << " * s; }\n";
+			out << "\t\tMETA_METHOD void set" << i << "(int i, double d) { i" << i << " = i; d" << i << " = d; }\n";
+			out << "\t\tMETA_METHOD int get" << i << "() { return i" << i << "; }\n";
+			out << "\t};\n";
+			if (i + 1 != count)
+				out << '\n';
+		}
+		out << "}\n";
+	}
+
+	//! \brief Compiles a file a few times with a command and keeps the fastest time.
+	//! \returns The time in seconds, or a negative value if the command failed.
+	double Time(const std::string& command, const std::string& file)
+	{
+		const std::string line = command + " " + file;
+		double best = -1.0;
+		for (int run = 0; run != 3; ++run)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			if (std::system(line.c_str()) != 0)
+			{
+				std::fprintf(stderr, "error: '%s' failed\n", line.c_str());
+				return -1.0;
+			}
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (best < 0.0 || seconds < best)
+				best = seconds;
+		}
+		return best;
+	}
+
+	//! \brief Compares the compile time of the definitions of synthetic types written as META_DEFINE chains, the
+	//! header-only template approach, with the same types written as constant tables.  Files are written to the
+	//! current directory, which must be able to include Meta.h.
+	int Bench(int count, const std::string& command)
+	{
+		const std::string header = "MetaGenBench.h";
+		{
+			std::ofstream out(header.c_str(), std::ios::binary);
+			Synthesize(out, count);
+		}
+
+		Parser parser;
+		if (!parser.Parse(header))
+			return 1;
+		const std::vector<std::string> headers(1, header);
+
+		const char* files[3] = { "MetaGenBenchNone.cpp", "MetaGenBenchChains.cpp", "MetaGenBenchTables.cpp" };
+		{
+			std::ofstream none(files[0], std::ios::binary);
+			none << "// Includes the synthetic types without defining them, as the baseline of the MetaGen build benchmark.\n\n#include \"Meta.h\"\n#include \"" << header << "\"\n";
+			std::ofstream chains(files[1], std::ios::binary);
+			Generate(parser, headers, false, chains);
+			std::ofstream tables(files[2], std::ios::binary);
+			Generate(parser, headers, true, tables);
+		}
+
+		static const char* const s_Names[3] = { "headers only", "chains", "tables" };
+		double seconds[3];
+		std::printf("%d types with 6 fields and 3 methods each, best of 3 builds\n%-14s %10s %14s\n", count, "variant", "seconds", "ms per type");
+		for (int i = 0; i != 3; ++i)
+		{
+			seconds[i] = Time(command, files[i]);
+			if (seconds[i] < 0.0)
+				return 1;
+			if (i == 0)
+				std::printf("%-14s %10.3f\n", s_Names[i], seconds[i]);
+			else
+				std::printf("%-14s %10.3f %14.3f\n", s_Names[i], seconds[i], (seconds[i] - seconds[0]) * 1000.0 / count);
+		}
+		return 0;
+	}
+
+	void Usage()
+	{
+		std::fprintf(stderr,
+			"usage: MetaGen [-static] -o Output.cpp Header.h...\n"
+			"         Writes the definitions of the META_TYPEs of the headers as META_DEFINE chains,\n"
+			"         or with -static as META_DEFINE_STATIC tables.\n"
+			"       MetaGen -bench Count \"compiler command\"\n"
+			"         Times the command compiling the definitions of Count synthetic types each way,\n"
+			"         e.g. MetaGen -bench 200 \"cl /nologo /c /O2 /EHsc\"\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc == 4 && std::strcmp(argv[1], "-bench") == 0)
+	{
+		const int count = std::atoi(argv[2]);
+		if (count <= 0)
+		{
+			Usage();
+			return 1;
+		}
+		return Bench(count, argv[3]);
+	}
+
+	bool tables = false;
+	std::string output;
+	std::vector<std::string> headers;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-static") == 0)
+			tables = true;
+		else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+			output = argv[++i];
+		else
+			headers.push_back(argv[i]);
+	}
+
+	if (output.empty() || headers.empty())
+	{
+		Usage();
+		return 1;
+	}
+	return Run(headers, output, tables);
+}
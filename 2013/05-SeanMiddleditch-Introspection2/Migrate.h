@@ -0,0 +1,262 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+
+#include <algorithm>
+#include <map>
+
+namespace Meta
+{
+	namespace internal
+	{
+		//! \brief Converts between two arithmetic types, for Migrator::SetConverter<From, To>().
+		template <typename From, typename To> struct convert_thunk
+		{
+			static void convert(const void* from, void* to) { *static_cast<To*>(to) = static_cast<To>(*static_cast<const From*>(from)); }
+		};
+	}
+
+	//! \brief Moves the state of objects of one version of a reflected type into another, e.g. after a plugin reload
+	//! defines a new version of a type (see Registry::FindLatest).
+	//! Members are matched by name, including members of bases. Members of the same type are copied, adjacent trivially
+	//! copyable ones merged into single memcpy runs; members whose type changed go through a converter if one is set, or
+	//! are matched member by member if both types are reflected classes; all other members of the new version keep the
+	//! value its default constructor gives them. Members accessed through getter and setter functions have no storage
+	//! and are not migrated. Each pair of versions is compiled into a plan once.
+	class Migrator
+	{
+	public:
+		//! \brief Converts a value of one type into an existing value of another.
+		typedef void (*Converter)(const void* from, void* to);
+
+		//! \brief One step of a Plan.
+		struct Step
+		{
+			enum Kind
+			{
+				Copy, //!< Copy size bytes.
+				Assign, //!< Copy assign a value of type.
+				Convert, //!< Convert with convert.
+			};
+
+			Kind kind; //!< What to do.
+			ptrdiff_t from; //!< Offset in the old object.
+			ptrdiff_t to; //!< Offset in the new object.
+			size_t size; //!< Bytes to copy.
+			const TypeInfo* type; //!< Type of an assigned value.
+			Converter convert; //!< Converter of a Convert.
+		};
+
+		//! \brief The compiled steps from one version to another, in order.
+		typedef std::vector<Step> Plan;
+
+	private:
+		typedef std::pair<const TypeInfo*, const TypeInfo*> Key;
+
+		//! \brief A plain data member found in a type or its bases.
+		struct Slot
+		{
+			const Member* member; //!< The member.
+			ptrdiff_t offset; //!< Offset of the member from the start of the object.
+		};
+
+		std::map<Key, Converter> m_Converters; //!< Converters by source and destination type.
+		internal::plan_cache<std::map<Key, Plan>> m_Plans; //!< Compiled plans by old and new type, built on first use.
+
+		//! \brief Collects the plain data members of a type and its bases.
+		static void Collect(std::vector<Slot>& slots, const TypeInfo* type, ptrdiff_t offset)
+		{
+			for (auto& e : type->GetAllMembers())
+			{
+				if (e.item->IsField() && e.item->GetType() != nullptr)
+				{
+					Slot s = { e.item, offset + e.offset + e.item->GetOffset() };
+					slots.push_back(s);
+				}
+			}
+		}
+
+		static bool IsComposite(const TypeInfo* type) { return !type->GetBases().empty() || !type->GetMembers().empty(); }
+
+		//! \brief Adds the steps that move the members of an old object at an offset into a new object at an offset.
+		void Compile(Plan& plan, const TypeInfo* from, ptrdiff_t fromOffset, const TypeInfo* to, ptrdiff_t toOffset) const
+		{
+			std::vector<Slot> source, target;
+			Collect(source, from, fromOffset);
+			Collect(target, to, toOffset);
+
+			for (auto& t : target)
+			{
+				auto s = std::find_if(source.begin(), source.end(), [&t](const Slot& s) { return std::strcmp(s.member->GetName(), t.member->GetName()) == 0; });
+				if (s == source.end())
+					continue; // a new member keeps its default value
+
+				const TypeInfo* st = s->member->GetType();
+				const TypeInfo* tt = t.member->GetType();
+				auto c = m_Converters.find(Key(st, tt));
+				if (st == tt && st->IsTriviallyCopyable())
+				{
+					Step step = { Step::Copy, s->offset, t.offset, st->GetSize(), st, nullptr };
+					plan.push_back(step);
+				}
+				else if (st == tt && st->CanAssign())
+				{
+					Step step = { Step::Assign, s->offset, t.offset, 0, st, nullptr };
+					plan.push_back(step);
+				}
+				else if (c != m_Converters.end())
+				{
+					Step step = { Step::Convert, s->offset, t.offset, 0, tt, c->second };
+					plan.push_back(step);
+				}
+				else if (st != tt && IsComposite(st) && IsComposite(tt))
+				{
+					Compile(plan, st, s->offset, tt, t.offset);
+				}
+				// members that cannot be copied or converted keep their default value
+			}
+		}
+
+		//! \brief Orders the steps by new offset and merges copies that are adjacent in both versions.
+		static void Optimize(Plan& plan)
+		{
+			std::stable_sort(plan.begin(), plan.end(), [](const Step& a, const Step& b) { return a.to < b.to; });
+
+			Plan merged;
+			merged.reserve(plan.size());
+			for (auto& s : plan)
+			{
+				if (s.kind == Step::Copy && !merged.empty() && merged.back().kind == Step::Copy)
+				{
+					Step& last = merged.back();
+					const ptrdiff_t size = static_cast<ptrdiff_t>(last.size);
+					if (last.from + size == s.from && last.to + size == s.to)
+					{
+						last.size += s.size;
+						continue;
+					}
+				}
+				merged.push_back(s);
+			}
+			plan.swap(merged);
+		}
+
+		Migrator()
+		{
+			SetConverters<int>();
+			SetConverters<float>();
+			SetConverters<double>();
+			SetConverters<char>();
+		}
+
+		Migrator(const Migrator&); // = delete
+		void operator=(const Migrator&); // = delete
+
+		//! \brief Sets converters from a type to each of the built-in arithmetic types.
+		template <typename From> void SetConverters()
+		{
+			SetConverter<From, int>();
+			SetConverter<From, float>();
+			SetConverter<From, double>();
+			SetConverter<From, char>();
+		}
+
+	public:
+		//! \brief Retrieves the migrator.
+		static Migrator& Instance() { static Migrator s_Migrator; return s_Migrator; }
+
+		//! \brief Sets the converter used when a member changes from one type to another.  Must be done before any plan using
+		//! the types is compiled.  Converters between int, float, double and char are set by default.
+		void SetConverter(const TypeInfo* from, const TypeInfo* to, Converter convert)
+		{
+			if (from == to)
+				return;
+			auto lock = m_Plans.Lock();
+			m_Converters[Key(from, to)] = convert;
+		}
+
+		//! \brief Sets the converter between two types to a static_cast.
+		template <typename From, typename To> void SetConverter() { SetConverter(Get<From>(), Get<To>(), &internal::convert_thunk<From, To>::convert); }
+
+		//! \brief Retrieves the plan from one version of a type to another, compiling it on first use.  Safe to call from any thread.
+		const Plan& GetPlan(const TypeInfo* from, const TypeInfo* to)
+		{
+			return m_Plans.Get(Key(from, to), [this, from, to]()
+			{
+				Plan plan;
+				Compile(plan, from, 0, to, 0);
+				Optimize(plan);
+				return plan;
+			});
+		}
+
+		//! \brief Constructs new objects from old ones.
+		//! \param from The old type.
+		//! \param to The new type, which must be default constructible.
+		//! \param src The first old object; the old objects are left unchanged.
+		//! \param srcStride The distance in bytes from one old object to the next.
+		//! \param dst Uninitialized storage for the first new object.
+		//! \param dstStride The distance in bytes from one new object to the next.
+		//! \param count The number of objects.
+		//! \returns False if the new type cannot be default constructed, in which case nothing is constructed.
+		bool Migrate(const TypeInfo* from, const TypeInfo* to, const void* src, size_t srcStride, void* dst, size_t dstStride, size_t count)
+		{
+			if (!to->CanConstruct())
+				return false;
+
+			const Plan& plan = GetPlan(from, to);
+			const Step* const begin = plan.data();
+			const Step* const end = begin + plan.size();
+			const char* s = static_cast<const char*>(src);
+			char* d = static_cast<char*>(dst);
+
+			// a trivially copyable type is default constructed once and then copied, rather than constructed per object
+			void* prototype = nullptr;
+			if (to->IsTriviallyCopyable() && count > 1)
+			{
+				prototype = internal::aligned_new(to->GetSize(), to->GetAlignment());
+				to->Construct(prototype);
+			}
+
+			for (size_t i = 0; i != count; ++i, s += srcStride, d += dstStride)
+			{
+				if (prototype != nullptr)
+					std::memcpy(d, prototype, to->GetSize());
+				else
+					to->Construct(d);
+
+				for (const Step* step = begin; step != end; ++step)
+				{
+					switch (step->kind)
+					{
+					case Step::Copy:
+						// single members are copied with fixed sizes the compiler turns into plain moves
+						if (step->size == 4)
+							std::memcpy(d + step->to, s + step->from, 4);
+						else if (step->size == 8)
+							std::memcpy(d + step->to, s + step->from, 8);
+						else
+							std::memcpy(d + step->to, s + step->from, step->size);
+						break;
+					case Step::Assign:
+						step->type->Assign(d + step->to, s + step->from);
+						break;
+					case Step::Convert:
+						step->convert(s + step->from, d + step->to);
+						break;
+					}
+				}
+			}
+
+			internal::aligned_delete(prototype);
+			return true;
+		}
+
+		//! \brief Constructs a new object from an old one.  See the batch Migrate above.
+		bool Migrate(const TypeInfo* from, const TypeInfo* to, const void* src, void* dst) { return Migrate(from, to, src, 0, dst, 0, 1); }
+	};
+}
@@ -0,0 +1,327 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+
+#include <algorithm>
+
+namespace Meta
+{
+	//! \brief One instruction of a Script.  Operands are register indices unless noted.
+	struct Instruction
+	{
+		enum Opcode
+		{
+			Load, //!< a = constant b
+			Move, //!< a = b
+			Add, //!< a = b + c, for two ints or two floats
+			Less, //!< a = b < c ? 1 : 0, for two ints or two floats
+			Jump, //!< continue at instruction a
+			JumpIfZero, //!< continue at instruction b if the int in a is 0
+			GetMember, //!< a = member of site c of the object b
+			SetMember, //!< member of site c of the object a = b
+			Call, //!< a = method of site c of the object b, called with the registers d onwards
+			Return, //!< finish with the value of a
+		};
+
+		Opcode op; //!< The operation
+		int a, b, c, d; //!< Operands
+	};
+
+	//! \brief A member or method access in a Script, with an inline cache of the lookups done for each receiver type.
+	//! The first receiver type makes the site monomorphic; up to MaxTypes types are cached before it becomes megamorphic
+	//! and resolves by name on every execution.
+	struct CallSite
+	{
+		static const unsigned MaxTypes = 4; //!< Receiver types cached before the site is megamorphic.
+		static const int MaxArgs = 4; //!< Arguments whose types are cached; calls with more are validated every time.
+
+		//! \brief A resolved lookup for one receiver type.
+		struct Entry
+		{
+			const TypeInfo* type; //!< The receiver type.
+			const Member* member; //!< The resolved member, for GetMember and SetMember.
+			const Method* method; //!< The resolved method, for Call.
+			ptrdiff_t offset; //!< Offset from the receiver to the owner of the member or method.
+			TypeRecord params[MaxArgs]; //!< The parameter types of method.
+		};
+
+		const char* name; //!< The name of the member or method.
+		int argc; //!< The number of arguments of a Call.
+		unsigned count; //!< The number of cached entries.
+		bool megamorphic; //!< Set once more than MaxTypes receiver types have been seen.
+		Entry entries[MaxTypes]; //!< The cached entries, most recently added last.
+	};
+
+	//! \brief A compiled script: instructions, constants and call sites.
+	class Script
+	{
+		std::vector<Instruction> m_Code; //!< The instructions.
+		std::vector<Any> m_Constants; //!< The constant pool.
+		std::vector<CallSite> m_Sites; //!< The call sites, including their caches.
+		int m_Registers; //!< The number of registers used.
+
+		friend class Interpreter;
+
+	public:
+		Script() : m_Registers(0) { }
+
+		//! \brief Adds a constant.
+		//! \returns The constant index for Load.
+		int AddConstant(const Any& value) { m_Constants.push_back(value); return static_cast<int>(m_Constants.size()) - 1; }
+
+		//! \brief Adds a call site for a member or method name.
+		//! \param argc The number of arguments, for a site used by Call.
+		//! \returns The site index for GetMember, SetMember or Call.
+		int AddSite(const char* name, int argc = 0)
+		{
+			CallSite site = CallSite();
+			site.name = name;
+			site.argc = argc;
+			m_Sites.push_back(site);
+			return static_cast<int>(m_Sites.size()) - 1;
+		}
+
+		//! \brief Appends an instruction.  Call sites must be added before the instructions that use them.
+		//! \returns The index of the instruction, for use as a jump target.
+		int Emit(Instruction::Opcode op, int a = 0, int b = 0, int c = 0, int d = 0)
+		{
+			Instruction i = { op, a, b, c, d };
+			m_Code.push_back(i);
+
+			int last = -1; // highest register the instruction uses
+			switch (op)
+			{
+			case Instruction::Load:
+			case Instruction::JumpIfZero:
+			case Instruction::Return:
+				last = a;
+				break;
+			case Instruction::Move:
+			case Instruction::GetMember:
+			case Instruction::SetMember:
+				last = std::max(a, b);
+				break;
+			case Instruction::Add:
+			case Instruction::Less:
+				last = std::max(a, std::max(b, c));
+				break;
+			case Instruction::Call:
+				last = std::max(std::max(a, b), d + m_Sites[c].argc - 1);
+				break;
+			case Instruction::Jump:
+				break;
+			}
+			if (last + 1 > m_Registers)
+				m_Registers = last + 1;
+			return static_cast<int>(m_Code.size()) - 1;
+		}
+
+		//! \brief Changes the jump target of a Jump or JumpIfZero instruction, e.g. once a forward target is known.
+		void Patch(int instruction, int target)
+		{
+			Instruction& i = m_Code[instruction];
+			(i.op == Instruction::Jump ? i.a : i.b) = target;
+		}
+
+		//! \brief Retrieves the index the next emitted instruction will have.
+		int GetNext() const { return static_cast<int>(m_Code.size()); }
+
+		//! \brief Retrieves a call site, e.g. to inspect its cache.
+		const CallSite& GetSite(int site) const { return m_Sites[site]; }
+	};
+
+	//! \brief Runs Scripts.  Reflected lookups are resolved once per call site and receiver type and then reused.
+	class Interpreter
+	{
+		std::vector<Any> m_Registers; //!< The registers of the running script.
+		const char* m_Error; //!< Description of the last failure.
+
+		//! \brief Finds the cached entry for a receiver type, resolving and caching it on a miss.
+		//! \returns The entry, or nullptr if the type has no such member or method.
+		const CallSite::Entry* Resolve(CallSite& site, const TypeInfo* type, bool method, CallSite::Entry& scratch)
+		{
+			for (unsigned i = 0; i != site.count; ++i)
+				if (site.entries[i].type == type)
+					return &site.entries[i];
+
+			CallSite::Entry e = CallSite::Entry();
+			e.type = type;
+			if (method)
+			{
+				auto found = type->FindMethodEntry(site.name);
+				if (found == nullptr)
+					return nullptr;
+				e.method = found->item;
+				e.offset = found->offset;
+				for (int i = 0; i < site.argc && i < CallSite::MaxArgs; ++i)
+					e.params[i] = e.method->GetParamType(i);
+			}
+			else
+			{
+				auto found = type->FindMemberEntry(site.name);
+				if (found == nullptr)
+					return nullptr;
+				e.member = found->item;
+				e.offset = found->offset;
+			}
+
+			if (site.count == CallSite::MaxTypes)
+			{
+				site.megamorphic = true;
+				scratch = e;
+				return &scratch;
+			}
+
+			site.entries[site.count] = e;
+			return &site.entries[site.count++];
+		}
+
+		//! \brief Checks the arguments of a Call against the cached parameter types.
+		static bool CheckArgs(const CallSite& site, const CallSite::Entry& e, const Any* argv)
+		{
+			if (site.argc != e.method->GetArity())
+				return false;
+			for (int i = 0; i != site.argc; ++i)
+			{
+				const TypeRecord param = i < CallSite::MaxArgs ? e.params[i] : e.method->GetParamType(i);
+				if (argv[i].GetType() != param.type)
+					return false;
+				if (argv[i].IsConst() && param.qualifier == TypeRecord::Pointer)
+					return false;
+			}
+			return true;
+		}
+
+		bool Fail(const char* error) { m_Error = error; return false; }
+
+		//! \brief Reads a primitive from a register, which must hold that exact type.
+		template <typename Type> static Type Read(const Any& reg) { return *static_cast<const Type*>(reg.GetPointer()); }
+
+		//! \brief Writes a primitive to a register, in place if it already holds a value of that type.
+		template <typename Type> static void Write(Any& reg, const TypeInfo* type, Type value)
+		{
+			if (reg.GetType() == type && reg.GetTypeRecord().qualifier == TypeRecord::Value)
+				*static_cast<Type*>(reg.GetPointer()) = value;
+			else
+				reg = Any(value);
+		}
+
+	public:
+		Interpreter() : m_Error(nullptr) { }
+
+		//! \brief Retrieves a description of the last failure, or nullptr.
+		const char* GetError() const { return m_Error; }
+
+		//! \brief Runs a script.
+		//! \param script The script; its call site caches are updated.
+		//! \param argc The number of arguments, copied into the first registers.
+		//! \param argv The arguments.
+		//! \param result Receives the value of the Return instruction.
+		//! \returns False if the script failed, in which case GetError describes why.
+		bool Run(Script& script, int argc, const Any* argv, Any& result)
+		{
+			m_Error = nullptr;
+			m_Registers.resize(script.m_Registers > argc ? script.m_Registers : argc);
+			for (int i = 0; i != argc; ++i)
+				m_Registers[i] = argv[i];
+
+			const TypeInfo* const intType = Get<int>();
+			const TypeInfo* const floatType = Get<float>();
+			Any* r = m_Registers.data();
+			const Instruction* code = script.m_Code.data();
+			const int size = static_cast<int>(script.m_Code.size());
+
+			for (int pc = 0; pc < size; ++pc)
+			{
+				const Instruction& i = code[pc];
+				switch (i.op)
+				{
+				case Instruction::Load:
+					r[i.a] = script.m_Constants[i.b];
+					break;
+				case Instruction::Move:
+					r[i.a] = r[i.b];
+					break;
+				case Instruction::Add:
+				case Instruction::Less:
+					{
+						const TypeInfo* type = r[i.b].GetType();
+						if (type != r[i.c].GetType())
+							return Fail("operands of different types");
+						if (type == intType)
+						{
+							const int lhs = Read<int>(r[i.b]), rhs = Read<int>(r[i.c]);
+							Write(r[i.a], intType, i.op == Instruction::Add ? lhs + rhs : int(lhs < rhs));
+						}
+						else if (type == floatType)
+						{
+							const float lhs = Read<float>(r[i.b]), rhs = Read<float>(r[i.c]);
+							if (i.op == Instruction::Add)
+								Write(r[i.a], floatType, lhs + rhs);
+							else
+								Write(r[i.a], intType, int(lhs < rhs));
+						}
+						else
+							return Fail("arithmetic on a type other than int or float");
+					}
+					break;
+				case Instruction::Jump:
+					pc = i.a - 1;
+					break;
+				case Instruction::JumpIfZero:
+					if (r[i.a].GetType() != intType)
+						return Fail("condition is not an int");
+					if (Read<int>(r[i.a]) == 0)
+						pc = i.b - 1;
+					break;
+				case Instruction::GetMember:
+				case Instruction::SetMember:
+				case Instruction::Call:
+					{
+						const Any& receiver = r[i.op == Instruction::SetMember ? i.a : i.b];
+						const TypeInfo* type = receiver.GetType();
+						if (type == nullptr || receiver.GetPointer() == nullptr)
+							return Fail("receiver is not an object");
+
+						CallSite& site = script.m_Sites[i.c];
+						CallSite::Entry scratch;
+						const CallSite::Entry* e = Resolve(site, type, i.op == Instruction::Call, scratch);
+						if (e == nullptr)
+							return Fail("no such member or method");
+
+						// the owner type is known from the cache, so the object is passed already adjusted
+						char* obj = static_cast<char*>(receiver.GetPointer()) + e->offset;
+						const TypeInfo* owner = i.op == Instruction::Call ? e->method->GetOwner() : e->member->GetOwner();
+						const Any self = receiver.IsConst() ? Any(static_cast<const void*>(obj), owner) : Any(static_cast<void*>(obj), owner);
+
+						if (i.op == Instruction::GetMember)
+							r[i.a] = e->member->Get(self);
+						else if (i.op == Instruction::SetMember)
+						{
+							if (!e->member->CanSet(self, r[i.b]))
+								return Fail("member cannot be set to this value");
+							e->member->Set(self, r[i.b]);
+						}
+						else
+						{
+							if (!CheckArgs(site, *e, r + i.d))
+								return Fail("arguments do not match the method");
+							r[i.a] = e->method->Call(self, site.argc, r + i.d);
+						}
+					}
+					break;
+				case Instruction::Return:
+					result = r[i.a];
+					return true;
+				}
+			}
+
+			result = Any();
+			return true;
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,294 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace Meta
+{
+	//! \brief Destination for serialized bytes.
+	class Writer
+	{
+	public:
+		virtual ~Writer() { }
+
+		//! \brief Appends bytes to the output.
+		virtual void Write(const void* data, size_t size) = 0;
+	};
+
+	//! \brief Source of serialized bytes.
+	class Reader
+	{
+	public:
+		virtual ~Reader() { }
+
+		//! \brief Retrieves the next bytes of the input without copying them where possible.
+		//! \returns A pointer valid until the next call, or nullptr if fewer than size bytes remain.
+		virtual const void* Acquire(size_t size) = 0;
+
+		//! \brief Copies the next bytes of the input.
+		//! \returns False if fewer than size bytes remain.
+		virtual bool Read(void* out, size_t size)
+		{
+			const void* data = Acquire(size);
+			if (data == nullptr)
+				return false;
+			std::memcpy(out, data, size);
+			return true;
+		}
+	};
+
+	//! \brief Writes into a growable memory buffer.
+	class BufferWriter : public Writer
+	{
+		std::vector<char> m_Buffer; //!< The bytes written so far.
+
+	public:
+		virtual void Write(const void* data, size_t size) override { m_Buffer.insert(m_Buffer.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size); }
+
+		//! \brief Retrieves the bytes written so far.
+		const std::vector<char>& GetBuffer() const { return m_Buffer; }
+
+		//! \brief Discards the bytes written so far, keeping the memory for reuse.
+		void Clear() { m_Buffer.clear(); }
+	};
+
+	//! \brief Writes to a binary output stream.
+	class StreamWriter : public Writer
+	{
+		std::ostream& m_Stream; //!< The output stream.
+
+		void operator=(const StreamWriter&); // = delete
+
+	public:
+		explicit StreamWriter(std::ostream& stream) : m_Stream(stream) { }
+
+		virtual void Write(const void* data, size_t size) override { m_Stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size)); }
+	};
+
+	//! \brief Reads from memory, such as a memory-mapped file, handing out pointers into it rather than copies.
+	class BufferReader : public Reader
+	{
+		const char* m_Data; //!< Start of the input.
+		size_t m_Size; //!< Size of the input in bytes.
+		size_t m_Position; //!< Bytes consumed so far.
+
+	public:
+		BufferReader(const void* data, size_t size) : m_Data(static_cast<const char*>(data)), m_Size(size), m_Position(0) { }
+
+		virtual const void* Acquire(size_t size) override
+		{
+			if (size > m_Size - m_Position)
+				return nullptr;
+			const char* data = m_Data + m_Position;
+			m_Position += size;
+			return data;
+		}
+
+		//! \brief Retrieves the number of bytes consumed so far.
+		size_t GetPosition() const { return m_Position; }
+	};
+
+	//! \brief Reads from a binary input stream.
+	class StreamReader : public Reader
+	{
+		std::istream& m_Stream; //!< The input stream.
+		std::vector<char> m_Scratch; //!< Holds the bytes returned by Acquire.
+
+		void operator=(const StreamReader&); // = delete
+
+	public:
+		explicit StreamReader(std::istream& stream) : m_Stream(stream) { }
+
+		virtual const void* Acquire(size_t size) override
+		{
+			m_Scratch.resize(size + 1);
+			return Read(m_Scratch.data(), size) ? m_Scratch.data() : nullptr;
+		}
+
+		virtual bool Read(void* out, size_t size) override
+		{
+			m_Stream.read(static_cast<char*>(out), static_cast<std::streamsize>(size));
+			return static_cast<size_t>(m_Stream.gcount()) == size;
+		}
+	};
+
+	namespace internal
+	{
+		//! \brief Codec for a type, used by Serializer::SetCodec<Type>().  Specialize for other types.
+		template <typename Type> struct codec;
+
+		//! \brief Codec for std::string: a 32-bit length followed by the characters.
+		template <> struct codec<std::string>
+		{
+			static void save(Writer& writer, const std::string& value)
+			{
+				const unsigned length = static_cast<unsigned>(value.size());
+				writer.Write(&length, sizeof(length));
+				writer.Write(value.data(), length);
+			}
+
+			static bool load(Reader& reader, std::string& value)
+			{
+				unsigned length;
+				if (!reader.Read(&length, sizeof(length)))
+					return false;
+				const void* data = reader.Acquire(length);
+				if (data == nullptr)
+					return false;
+				value.assign(static_cast<const char*>(data), length);
+				return true;
+			}
+		};
+
+		//! \brief Adapts internal::codec<Type> to Serializer::Codec.
+		template <typename Type> struct codec_thunk
+		{
+			static void save(Writer& writer, const void* obj) { codec<Type>::save(writer, *static_cast<const Type*>(obj)); }
+			static bool load(Reader& reader, void* obj) { return codec<Type>::load(reader, *static_cast<Type*>(obj)); }
+		};
+	}
+
+	//! \brief Saves and loads reflected objects in a compact binary form.
+	//! Each type is compiled once into a FieldPlan over its own and inherited members. Adjacent trivially copyable fields
+	//! are merged into single copies, types with a codec (such as std::string) are written by it, and members accessed
+	//! through getter and setter functions go through Member::Get and Member::Set. A type with a value none of these can
+	//! handle is refused rather than saved without it. The format follows the in-memory layout, so it is only meant to be
+	//! read back by the same build.
+	class Serializer
+	{
+	public:
+		//! \brief Writes and reads a type that cannot be copied as raw bytes.
+		struct Codec
+		{
+			void (*save)(Writer& writer, const void* obj); //!< Writes the object.
+			bool (*load)(Reader& reader, void* obj); //!< Reads into an existing object; returns false on truncated input.
+		};
+
+		//! \brief The compiled steps for a type, in order.
+		typedef FieldPlan<Codec> Plan;
+
+		//! \brief One step of a Plan.
+		typedef Plan::Step Step;
+
+	private:
+		std::unordered_map<const TypeInfo*, Codec> m_Codecs; //!< Codecs by type.
+		internal::plan_cache<std::unordered_map<const TypeInfo*, Plan>> m_Plans; //!< Compiled plans by type, built on first use.
+
+		Serializer() { }
+		Serializer(const Serializer&); // = delete
+		void operator=(const Serializer&); // = delete
+
+	public:
+		//! \brief Retrieves the serializer.
+		static Serializer& Instance() { static Serializer s_Serializer; return s_Serializer; }
+
+		//! \brief Sets the codec for a type.  Must be done before any plan using the type is compiled.
+		void SetCodec(const TypeInfo* type, const Codec& codec)
+		{
+			auto lock = m_Plans.Lock();
+			m_Codecs[type] = codec;
+		}
+
+		//! \brief Sets the codec for a type to internal::codec<Type>.
+		template <typename Type> void SetCodec()
+		{
+			Codec codec = { &internal::codec_thunk<Type>::save, &internal::codec_thunk<Type>::load };
+			SetCodec(Get<Type>(), codec);
+		}
+
+		//! \brief Retrieves the plan for a type, compiling it on first use.  Safe to call from any thread.
+		const Plan& GetPlan(const TypeInfo* type) { return m_Plans.Get(type, [this, type]() { return Plan::Compile(type, m_Codecs, true); }); }
+
+		//! \brief Writes an object.
+		//! \param writer The destination.
+		//! \param type The exact type of the object.
+		//! \param obj The object.
+		//! \returns False if the plan for the type is incomplete (see FieldPlan), in which case nothing is written, or that of
+		//! a property value is, in which case the output stops there.
+		bool Save(Writer& writer, const TypeInfo* type, const void* obj)
+		{
+			const Plan& plan = GetPlan(type);
+			if (!plan.IsComplete())
+				return false;
+
+			const char* base = static_cast<const char*>(obj);
+			for (auto& s : plan)
+			{
+				switch (s.kind)
+				{
+				case Step::Bytes:
+					writer.Write(base + s.offset, s.size);
+					break;
+				case Step::Field:
+					s.handler->save(writer, base + s.offset);
+					break;
+				case Step::Property:
+					{
+						Any value = s.member->Get(Any(static_cast<const void*>(base + s.offset), s.owner));
+						if (!Save(writer, s.type, value.GetPointer()))
+							return false;
+					}
+					break;
+				}
+			}
+			return true;
+		}
+
+		//! \brief Reads into an existing object.
+		//! \param reader The source.
+		//! \param type The exact type of the object.
+		//! \param obj The object.
+		//! \returns False if the input was truncated, in which case the object may be partially loaded, or if the plan for
+		//! the type is incomplete.
+		bool Load(Reader& reader, const TypeInfo* type, void* obj)
+		{
+			const Plan& plan = GetPlan(type);
+			if (!plan.IsComplete())
+				return false;
+
+			char* base = static_cast<char*>(obj);
+			for (auto& s : plan)
+			{
+				switch (s.kind)
+				{
+				case Step::Bytes:
+					if (!reader.Read(base + s.offset, s.size))
+						return false;
+					break;
+				case Step::Field:
+					if (!s.handler->load(reader, base + s.offset))
+						return false;
+					break;
+				case Step::Property:
+					{
+						void* value = internal::aligned_new(s.type->GetSize(), s.type->GetAlignment());
+						s.type->Construct(value);
+						const bool loaded = Load(reader, s.type, value);
+						if (loaded)
+							s.member->Set(Any(base + s.offset, s.owner), Any(value, s.type));
+						s.type->Destruct(value);
+						internal::aligned_delete(value);
+						if (!loaded)
+							return false;
+					}
+					break;
+				}
+			}
+			return true;
+		}
+
+		//! \brief Writes an object of a statically known type.
+		template <typename Type> bool Save(Writer& writer, const Type& obj) { return Save(writer, Get<Type>(), &obj); }
+
+		//! \brief Reads into an existing object of a statically known type.
+		template <typename Type> bool Load(Reader& reader, Type& obj) { return Load(reader, Get<Type>(), &obj); }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,358 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+
+#include <cassert>
+
+namespace Meta
+{
+	//! \brief A typed view of contiguous elements, such as one column of a SoaArray.
+	template <typename Type> struct Span
+	{
+		Type* data; //!< The first element
+		size_t size; //!< The number of elements
+
+		Span() : data(nullptr), size(0) { }
+		Span(Type* d, size_t s) : data(d), size(s) { }
+
+		Type* begin() const { return data; }
+		Type* end() const { return data + size; }
+		Type& operator[](size_t i) const { return data[i]; }
+		bool empty() const { return size == 0; }
+	};
+
+	//! \brief A growable, type-erased array of objects of a reflected type, aligned to a cache line.
+	//! Elements are default constructed, moved and destructed through the TypeInfo, or copied as bytes for trivially copyable types.
+	class Column
+	{
+	public:
+		static const size_t Alignment = 64; //!< Minimum alignment of the storage, enough for any SIMD load.
+
+	private:
+		const TypeInfo* m_Type; //!< The type of the elements.
+		char* m_Data; //!< Aligned storage for m_Capacity elements.
+		size_t m_Size; //!< Number of live elements.
+		size_t m_Capacity; //!< Number of elements that fit in the storage.
+
+		Column(const Column&); // = delete
+		void operator=(const Column&); // = delete
+
+		size_t GetStorageAlignment() const { return m_Type->GetAlignment() > Alignment ? m_Type->GetAlignment() : Alignment; }
+
+		//! \brief Allocates storage aligned to GetStorageAlignment.
+		char* AllocateStorage(size_t capacity) const { return static_cast<char*>(internal::aligned_new(capacity * m_Type->GetSize(), GetStorageAlignment())); }
+
+		static void FreeStorage(char* data) { internal::aligned_delete(data); }
+
+		//! \brief Makes room for one more element and returns its uninitialized storage.
+		void* Grow()
+		{
+			if (m_Size == m_Capacity)
+				Reserve(m_Capacity != 0 ? m_Capacity * 2 : 16);
+			return At(m_Size++);
+		}
+
+	public:
+		explicit Column(const TypeInfo* type) : m_Type(type), m_Data(nullptr), m_Size(0), m_Capacity(0) { assert(type->GetSize() != 0); }
+		Column(Column&& src) noexcept : m_Type(src.m_Type), m_Data(src.m_Data), m_Size(src.m_Size), m_Capacity(src.m_Capacity) { src.m_Data = nullptr; src.m_Size = src.m_Capacity = 0; }
+		~Column() { Clear(); FreeStorage(m_Data); }
+
+		//! \brief Retrieves the type of the elements.
+		const TypeInfo* GetType() const { return m_Type; }
+
+		//! \brief Retrieves the number of elements.
+		size_t GetSize() const { return m_Size; }
+
+		//! \brief Retrieves the number of elements that fit without reallocating.
+		size_t GetCapacity() const { return m_Capacity; }
+
+		//! \brief Retrieves the storage of the first element.
+		void* GetData() const { return m_Data; }
+
+		//! \brief Retrieves an element.
+		void* At(size_t index) const { return m_Data + index * m_Type->GetSize(); }
+
+		//! \brief Retrieves the elements as a typed span.  Type must be the element type.
+		template <typename Type> Span<Type> GetSpan() const
+		{
+			assert(Get<Type>() == m_Type);
+			return Span<Type>(reinterpret_cast<Type*>(m_Data), m_Size);
+		}
+
+		//! \brief Makes room for at least capacity elements, moving the existing ones.
+		void Reserve(size_t capacity)
+		{
+			if (capacity <= m_Capacity)
+				return;
+
+			char* data = AllocateStorage(capacity);
+			if (m_Type->IsTriviallyCopyable())
+			{
+				if (m_Size != 0)
+					std::memcpy(data, m_Data, m_Size * m_Type->GetSize());
+			}
+			else
+			{
+				assert(m_Type->CanRelocate());
+				for (size_t i = 0; i != m_Size; ++i)
+					m_Type->Relocate(data + i * m_Type->GetSize(), At(i));
+			}
+
+			FreeStorage(m_Data);
+			m_Data = data;
+			m_Capacity = capacity;
+		}
+
+		//! \brief Appends a default constructed element.
+		//! \returns The new element.
+		void* Push()
+		{
+			assert(m_Type->CanConstruct());
+			void* obj = Grow();
+			m_Type->Construct(obj);
+			return obj;
+		}
+
+		//! \brief Appends a copy of an object of the element type.
+		//! \returns The new element.
+		void* Push(const void* src)
+		{
+			if (m_Type->IsTriviallyCopyable())
+				return std::memcpy(Grow(), src, m_Type->GetSize());
+
+			void* obj = Push();
+			m_Type->Assign(obj, src);
+			return obj;
+		}
+
+		//! \brief Appends an object of the element type by moving it; the source is left destructed.
+		//! \returns The new element.
+		void* PushRelocated(void* src)
+		{
+			if (m_Type->IsTriviallyCopyable())
+				return std::memcpy(Grow(), src, m_Type->GetSize());
+
+			void* obj = Grow();
+			m_Type->Relocate(obj, src);
+			return obj;
+		}
+
+		//! \brief Removes an element by moving the last element into its place.
+		void SwapRemove(size_t index)
+		{
+			assert(index < m_Size);
+			void* obj = At(index);
+			void* last = At(m_Size - 1);
+			if (m_Type->IsTriviallyCopyable())
+			{
+				if (obj != last)
+					std::memcpy(obj, last, m_Type->GetSize());
+			}
+			else
+			{
+				m_Type->Destruct(obj);
+				if (obj != last)
+					m_Type->Relocate(obj, last);
+			}
+			--m_Size;
+		}
+
+		//! \brief Removes an element that has already been relocated elsewhere by moving the last element into its place.
+		void SwapRemoveRelocated(size_t index)
+		{
+			assert(index < m_Size);
+			void* obj = At(index);
+			void* last = At(m_Size - 1);
+			if (obj != last)
+			{
+				if (m_Type->IsTriviallyCopyable())
+					std::memcpy(obj, last, m_Type->GetSize());
+				else
+					m_Type->Relocate(obj, last);
+			}
+			--m_Size;
+		}
+
+		//! \brief Destructs all elements, keeping the storage.
+		void Clear()
+		{
+			if (!m_Type->IsTriviallyCopyable())
+				for (size_t i = 0; i != m_Size; ++i)
+					m_Type->Destruct(At(i));
+			m_Size = 0;
+		}
+	};
+
+	//! \brief Stores objects of a reflected type as a structure of arrays: one aligned Column per plain data member,
+	//! including members inherited from bases.  Code that touches only a few members of many objects streams only
+	//! those columns.  Members accessed through getter and setter functions have no storage and are not kept.
+	class SoaArray
+	{
+	public:
+		//! \brief A reflected member and the column storing it.
+		struct Field
+		{
+			const Member* member; //!< The reflected member.
+			ptrdiff_t offset; //!< Offset of the member within an object of the stored type.
+			Column column; //!< The values of the member for every row.
+
+			Field(const Member* m, ptrdiff_t o) : member(m), offset(o), column(m->GetType()) { }
+		};
+
+	private:
+		const TypeInfo* m_Type; //!< The stored type.
+		std::vector<Field> m_Fields; //!< Columns in member order, bases first.
+		size_t m_Size; //!< Number of rows.
+
+		SoaArray(const SoaArray&); // = delete
+		void operator=(const SoaArray&); // = delete
+
+		//! \brief Adds a column for each plain data member of a type and its bases.
+		void AddFields(const TypeInfo* type)
+		{
+			for (auto& e : type->GetAllMembers())
+				if (e.item->IsField() && e.item->GetType() != nullptr)
+					m_Fields.push_back(Field(e.item, e.offset + e.item->GetOffset()));
+		}
+
+	public:
+		//! \brief Creates an empty array for objects of a type.
+		explicit SoaArray(const TypeInfo* type) : m_Type(type), m_Size(0) { AddFields(type); }
+
+		//! \brief Retrieves the stored type.
+		const TypeInfo* GetType() const { return m_Type; }
+
+		//! \brief Retrieves the number of rows.
+		size_t GetSize() const { return m_Size; }
+
+		//! \brief Retrieves the columns.
+		const std::vector<Field>& GetFields() const { return m_Fields; }
+
+		//! \brief Finds the column for a member.
+		//! \returns The field or nullptr if the type has no plain data member with that name.
+		const Field* FindField(const char* name) const
+		{
+			for (auto& f : m_Fields)
+				if (std::strcmp(f.member->GetName(), name) == 0)
+					return &f;
+			return nullptr;
+		}
+
+		//! \brief Finds the column for a member of a specific type.
+		//! \returns The field or nullptr if the type has no plain data member with that name and type.
+		template <typename Type> const Field* FindField(const char* name) const
+		{
+			auto f = FindField(name);
+			return f != nullptr && f->column.GetType() == Meta::Get<Type>() ? f : nullptr;
+		}
+
+		//! \brief Retrieves the values of a member as a typed span.
+		//! \returns The span, or an empty span if there is no such member of type Type.
+		template <typename Type> Span<Type> GetColumn(const char* name) const
+		{
+			auto f = FindField<Type>(name);
+			return f != nullptr ? f->column.template GetSpan<Type>() : Span<Type>();
+		}
+
+		//! \brief Makes room for at least capacity rows.
+		void Reserve(size_t capacity)
+		{
+			for (auto& f : m_Fields)
+				f.column.Reserve(capacity);
+		}
+
+		//! \brief Appends a row of default constructed members.
+		//! \returns The index of the new row.
+		size_t Push()
+		{
+			for (auto& f : m_Fields)
+				f.column.Push();
+			return m_Size++;
+		}
+
+		//! \brief Appends a row holding the members of an object.
+		//! \param obj An object of the stored type.
+		//! \returns The index of the new row.
+		size_t Push(const void* obj)
+		{
+			for (auto& f : m_Fields)
+				f.column.Push(static_cast<const char*>(obj) + f.offset);
+			return m_Size++;
+		}
+
+		//! \brief Removes a row by moving the last row into its place.
+		void SwapRemove(size_t row)
+		{
+			for (auto& f : m_Fields)
+				f.column.SwapRemove(row);
+			--m_Size;
+		}
+
+		//! \brief Removes all rows.
+		void Clear()
+		{
+			for (auto& f : m_Fields)
+				f.column.Clear();
+			m_Size = 0;
+		}
+
+		//! \brief Copies the members of an object into a row.
+		//! \param obj An object of the stored type.
+		void Store(size_t row, const void* obj)
+		{
+			for (auto& f : m_Fields)
+			{
+				const void* src = static_cast<const char*>(obj) + f.offset;
+				if (f.column.GetType()->IsTriviallyCopyable())
+					std::memcpy(f.column.At(row), src, f.column.GetType()->GetSize());
+				else
+					f.column.GetType()->Assign(f.column.At(row), src);
+			}
+		}
+
+		//! \brief Copies a row into the members of an object.
+		//! \param obj An object of the stored type.
+		void Load(size_t row, void* obj) const
+		{
+			for (auto& f : m_Fields)
+			{
+				void* dst = static_cast<char*>(obj) + f.offset;
+				if (f.column.GetType()->IsTriviallyCopyable())
+					std::memcpy(dst, f.column.At(row), f.column.GetType()->GetSize());
+				else
+					f.column.GetType()->Assign(dst, f.column.At(row));
+			}
+		}
+
+		//! \brief Retrieves a reference to the value of a member in a row.
+		Any Get(size_t row, const Field& field) const { return Any(field.column.At(row), field.column.GetType()); }
+
+		//! \brief Sets every value of a member.
+		//! \returns False if there is no such member of type Type.
+		template <typename Type> bool Fill(const char* name, const Type& value)
+		{
+			auto f = FindField<Type>(name);
+			if (f == nullptr)
+				return false;
+			for (auto& v : f->column.template GetSpan<Type>())
+				v = value;
+			return true;
+		}
+
+		//! \brief Calls a function with a reference to every value of a member.
+		//! \returns False if there is no such member of type Type.
+		template <typename Type, typename Function> bool ForEach(const char* name, Function fn)
+		{
+			auto f = FindField<Type>(name);
+			if (f == nullptr)
+				return false;
+			for (auto& v : f->column.template GetSpan<Type>())
+				fn(v);
+			return true;
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,224 @@
+// Copyright (C) 2013 Sean Middleditch
+// All rights reserverd.  This code is intended for instructional use only and may not be used
+// in any commercial works nor in any student projects.
+
+#pragma once
+
+#include "Meta.h"
+#include "Soa.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace Meta
+{
+	//! \brief Animates reflected float members from one value to another over time.
+	//! Each member is resolved once to a field offset when the tween is added. Active tweens are grouped into channels
+	//! by object type, member and easing curve, each storing its tweens as aligned columns, so an update evaluates a
+	//! whole channel in a loop the compiler can vectorize and then scatters the results into the objects.
+	class Tweener
+	{
+	public:
+		//! \brief Easing curves, applied to the normalized time of a tween.
+		enum Ease
+		{
+			Linear, //!< Constant speed
+			QuadIn, //!< Accelerates from rest
+			QuadOut, //!< Decelerates to rest
+			SmoothStep, //!< Accelerates and decelerates
+		};
+
+	private:
+		//! \brief The tweens of one member of one type with one curve.
+		struct Channel
+		{
+			std::vector<float*> targets; //!< The animated values.
+			Column from; //!< The start values.
+			Column to; //!< The end values.
+			Column time; //!< The normalized time, from 0 to 1.
+			Column rate; //!< The normalized time per second, 1 / duration.
+
+			Channel() : from(Get<float>()), to(Get<float>()), time(Get<float>()), rate(Get<float>()) { }
+		};
+
+		typedef std::tuple<const TypeInfo*, ptrdiff_t, Ease> Key;
+
+		std::map<Key, Channel> m_Channels; //!< Channels ordered by type, member and curve.
+		size_t m_Count; //!< Number of active tweens.
+
+		Tweener(const Tweener&); // = delete
+		void operator=(const Tweener&); // = delete
+
+		static const size_t BlockSize = 256; //!< Tweens evaluated before their values are scattered, sized to stay in L1.
+
+		static float* Data(const Column& column) { return static_cast<float*>(column.GetData()); }
+
+		//! \brief Advances a block of tweens and computes their values with one curve.
+		template <typename Curve> static void Evaluate(const float* __restrict from, const float* __restrict to, float* __restrict time, const float* __restrict rate, float* __restrict value, size_t count, float dt, Curve curve)
+		{
+			// the columns never overlap and the objects are not written here, so the loop vectorizes
+			for (size_t i = 0; i != count; ++i)
+			{
+				const float t = std::min(time[i] + dt * rate[i], 1.f);
+				time[i] = t;
+				value[i] = Lerp(from[i], to[i], curve(t));
+			}
+		}
+
+		//! \brief Advances the tweens of a channel and writes their values to the objects.
+		//! \returns The number of tweens that finished.
+		template <typename Curve> static size_t Update(Channel& c, float dt, Curve curve)
+		{
+			const size_t count = c.targets.size();
+			float* const* targets = c.targets.data();
+			const float* time = Data(c.time);
+			size_t finished = 0;
+			alignas(Column::Alignment) float value[BlockSize];
+
+			for (size_t begin = 0; begin < count; begin += BlockSize)
+			{
+				const size_t size = count - begin < BlockSize ? count - begin : BlockSize;
+				Evaluate(Data(c.from) + begin, Data(c.to) + begin, Data(c.time) + begin, Data(c.rate) + begin, value, size, dt, curve);
+				for (size_t i = 0; i != size; ++i)
+				{
+					*targets[begin + i] = value[i];
+					finished += time[begin + i] >= 1.f;
+				}
+			}
+			return finished;
+		}
+
+		//! \brief Removes a tween from a channel by moving the last one into its place.
+		void Remove(Channel& c, size_t i)
+		{
+			c.targets[i] = c.targets.back();
+			c.targets.pop_back();
+			c.from.SwapRemove(i);
+			c.to.SwapRemove(i);
+			c.time.SwapRemove(i);
+			c.rate.SwapRemove(i);
+			--m_Count;
+		}
+
+	public:
+		Tweener() : m_Count(0) { }
+
+		//! \brief Applies an easing curve to a normalized time from 0 to 1.
+		static float Curve(Ease ease, float t)
+		{
+			switch (ease)
+			{
+			case QuadIn:
+				return t * t;
+			case QuadOut:
+				return t * (2.f - t);
+			case SmoothStep:
+				return t * t * (3.f - 2.f * t);
+			default:
+				return t;
+			}
+		}
+
+		//! \brief Blends from one value to another by an eased time.  Weighting both ends, rather than adding a scaled
+		//! difference to the start, gives exactly from at 0 and exactly to at 1 even when they differ greatly in magnitude.
+		static float Lerp(float from, float to, float c) { return from * (1.f - c) + to * c; }
+
+		//! \brief Retrieves the number of active tweens.
+		size_t GetCount() const { return m_Count; }
+
+		//! \brief Starts animating a float member of an object.  The member is first written by the next Update.
+		//! \param type The exact type of the object.
+		//! \param obj The object, which must outlive the tween or be passed to Cancel.
+		//! \param name The name of a plain float member of the type or of one of its bases.
+		//! \param duration The length of the tween in seconds.
+		//! \returns False if the type has no plain float member with that name.
+		bool Add(const TypeInfo* type, void* obj, const char* name, float from, float to, float duration, Ease ease = Linear)
+		{
+			auto field = type->FindField<float>(name);
+			if (!field.IsValid())
+				return false;
+
+			Channel& c = m_Channels[Key(type, field.GetOffset(), ease)];
+			const float time = 0.f, rate = duration > 0.f ? 1.f / duration : 1e30f;
+			c.targets.push_back(&field.Ref(obj));
+			c.from.Push(&from);
+			c.to.Push(&to);
+			c.time.Push(&time);
+			c.rate.Push(&rate);
+			++m_Count;
+			return true;
+		}
+
+		//! \brief Starts animating a float member of an object of a statically known type.
+		template <typename Type> bool Add(Type& obj, const char* name, float from, float to, float duration, Ease ease = Linear)
+		{
+			return Add(Get<Type>(), &obj, name, from, to, duration, ease);
+		}
+
+		//! \brief Stops every tween animating a member of an object.
+		//! \param type The exact type of the object.
+		void Cancel(const TypeInfo* type, const void* obj)
+		{
+			const char* begin = static_cast<const char*>(obj);
+			const char* end = begin + type->GetSize();
+			for (auto& entry : m_Channels)
+			{
+				Channel& c = entry.second;
+				for (size_t i = c.targets.size(); i-- != 0; )
+				{
+					const char* target = reinterpret_cast<const char*>(c.targets[i]);
+					if (target >= begin && target < end)
+						Remove(c, i);
+				}
+			}
+		}
+
+		//! \brief Stops all tweens.
+		void Clear()
+		{
+			m_Channels.clear();
+			m_Count = 0;
+		}
+
+		//! \brief Advances all tweens and writes their values to the objects.  Finished tweens write their end value and are removed.
+		//! \param dt The elapsed time in seconds.
+		void Update(float dt)
+		{
+			for (auto& entry : m_Channels)
+			{
+				Channel& c = entry.second;
+				if (c.targets.empty())
+					continue;
+
+				// each lambda passes Curve a constant, so the switch in it folds away and the loop stays vectorizable
+				size_t finished = 0;
+				switch (std::get<2>(entry.first))
+				{
+				case Linear:
+					finished = Update(c, dt, [](float t) { return Curve(Linear, t); });
+					break;
+				case QuadIn:
+					finished = Update(c, dt, [](float t) { return Curve(QuadIn, t); });
+					break;
+				case QuadOut:
+					finished = Update(c, dt, [](float t) { return Curve(QuadOut, t); });
+					break;
+				case SmoothStep:
+					finished = Update(c, dt, [](float t) { return Curve(SmoothStep, t); });
+					break;
+				}
+
+				const float* time = Data(c.time);
+				for (size_t i = c.targets.size(); finished != 0 && i-- != 0; )
+				{
+					if (time[i] >= 1.f)
+					{
+						Remove(c, i);
+						--finished;
+					}
+				}
+			}
+		}
+	};
+}
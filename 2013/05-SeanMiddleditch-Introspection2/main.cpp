@@ -3,8 +3,21 @@
 // in any commercial works nor in any student projects.
 
 #include "Meta.h"
+#include "Actions.h"
+#include "Components.h"
+#include "Database.h"
+#include "Hash.h"
+#include "Layout.h"
+#include "Migrate.h"
+#include "Script.h"
+#include "Serialize.h"
+#include "Soa.h"
+#include "Tween.h"
 
 #include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 #include <string>
 
 // a test class
@@ -51,6 +64,8 @@ class B : public A1, public A2
 public:
 	float c;
 
+	float lerp(float from, float to, float t) { return from + (to - from) * t; }
+
 	META_DECLARE(B);
 };
 
@@ -63,6 +78,99 @@ namespace TestC
 	};
 }
 
+// a test with constant tables
+namespace TestD
+{
+	struct Tag
+	{
+		int id;
+	};
+
+	struct Body : Tag, TestC::C
+	{
+		float mass;
+		std::string label;
+
+		float scaled(float s) { return mass * s; }
+		void rename(const std::string& l) { label = l; }
+		std::string& getLabel() { return label; }
+	};
+}
+
+// two versions of a type, as before and after a plugin reload
+namespace V1
+{
+	struct Unit
+	{
+		int id;
+		float speed;
+		float hp;
+		std::string name;
+		TestC::C pos;
+	};
+}
+
+namespace V2
+{
+	struct Unit
+	{
+		int id;
+		float speed;
+		double hp;
+		std::string name;
+		TestC::C pos;
+		float armor;
+
+		Unit() : id(0), speed(0.f), hp(0.0), armor(5.f) { pos.x = pos.y = 0.f; }
+	};
+}
+
+// math types that need more alignment than a double, as SSE and AVX vectors do
+struct alignas(16) Vec4
+{
+	float x, y, z, w;
+};
+
+struct alignas(32) Mat4
+{
+	float m[16];
+};
+
+struct Transform
+{
+	char tag;
+	Vec4 position;
+	Mat4 world;
+
+	Vec4 apply(const Vec4& v) { Vec4 r = { v.x + world.m[12], v.y + world.m[13], v.z + world.m[14], v.w }; return r; }
+};
+
+// a type with members in a wasteful order
+struct Particle
+{
+	char alive;
+	double x;
+	char kind;
+	double y;
+	float life;
+};
+
+// holds a value that has no codec or comparer, no reflected members and no trivial copy
+struct Resource
+{
+	int id;
+	std::vector<int> handles;
+};
+
+// a type defined before its base
+struct TaggedParticle : Particle
+{
+	int tag;
+};
+
+// dynamically initialized before the tables below are defined, which is safe because they are constant-initialized
+static const bool s_StaticReadyEarly = Meta::GetStatic<TestD::Body>()->FindField<float>("mass").IsValid();
+
 // create m_Type infos
 META_DEFINE_EXTERN(std::string);
 
@@ -86,12 +194,81 @@ META_DEFINE(B)
 	.base<A1>()
 	.base<A2>()
 	.member("c", &B::c)
-	.method("gar", &B::gar);
+	.method("gar", &B::gar)
+	.method("lerp", &B::lerp);
 
 META_DEFINE_EXTERN(TestC::C)
 	.member("x", &TestC::C::x)
 	.member("y", &TestC::C::y);
 
+META_DEFINE_EXTERN(TestD::Tag)
+	.member("id", &TestD::Tag::id);
+
+META_DEFINE_EXTERN(TestD::Body)
+	.base<TestD::Tag>()
+	.base<TestC::C>()
+	.member("mass", &TestD::Body::mass)
+	.member("label", &TestD::Body::label);
+
+META_DEFINE_EXTERN(V1::Unit)
+	.member("id", &V1::Unit::id)
+	.member("speed", &V1::Unit::speed)
+	.member("hp", &V1::Unit::hp)
+	.member("name", &V1::Unit::name)
+	.member("pos", &V1::Unit::pos);
+
+META_DEFINE_EXTERN(V2::Unit)
+	.member("id", &V2::Unit::id)
+	.member("speed", &V2::Unit::speed)
+	.member("hp", &V2::Unit::hp)
+	.member("name", &V2::Unit::name)
+	.member("pos", &V2::Unit::pos)
+	.member("armor", &V2::Unit::armor);
+
+META_DEFINE_EXTERN(Vec4)
+	.member("x", &Vec4::x)
+	.member("y", &Vec4::y)
+	.member("z", &Vec4::z)
+	.member("w", &Vec4::w);
+
+META_DEFINE_EXTERN(Mat4);
+
+META_DEFINE_EXTERN(Transform)
+	.member("position", &Transform::position)
+	.member("world", &Transform::world)
+	.method("apply", &Transform::apply);
+
+META_DEFINE_EXTERN(std::vector<int>);
+
+META_DEFINE_EXTERN(Resource)
+	.member("id", &Resource::id)
+	.member("handles", &Resource::handles);
+
+META_DEFINE_EXTERN(TaggedParticle)
+	.base<Particle>()
+	.member("tag", &TaggedParticle::tag);
+
+// looked up before Particle is defined, so the inherited members are not found yet
+static const bool s_TaggedEarly = Meta::Get<TaggedParticle>()->FindMember("tag") != nullptr && Meta::Get<TaggedParticle>()->FindMember("x") == nullptr;
+
+META_DEFINE_EXTERN(Particle)
+	.member("alive", &Particle::alive)
+	.member("x", &Particle::x)
+	.member("kind", &Particle::kind)
+	.member("y", &Particle::y)
+	.member("life", &Particle::life);
+
+static constexpr Meta::StaticField s_TestCFields[] = { META_STATIC_FIELD(TestC::C, x), META_STATIC_FIELD(TestC::C, y) };
+META_DEFINE_STATIC(TestC::C, {}, s_TestCFields, {});
+
+static constexpr Meta::StaticField s_TagFields[] = { META_STATIC_FIELD(TestD::Tag, id) };
+META_DEFINE_STATIC(TestD::Tag, {}, s_TagFields, {});
+
+static constexpr Meta::StaticBase s_BodyBases[] = { META_STATIC_BASE(TestD::Body, TestD::Tag), META_STATIC_BASE(TestD::Body, TestC::C) };
+static constexpr Meta::StaticField s_BodyFields[] = { META_STATIC_FIELD(TestD::Body, mass), META_STATIC_FIELD(TestD::Body, label) };
+static constexpr Meta::StaticMethod s_BodyMethods[] = { META_STATIC_METHOD(TestD::Body, scaled), META_STATIC_METHOD(TestD::Body, rename), META_STATIC_METHOD(TestD::Body, getLabel) };
+META_DEFINE_STATIC(TestD::Body, s_BodyBases, s_BodyFields, s_BodyMethods);
+
 // tests that a value can be round-tripped into a member variable
 template <typename T, typename U> static void test_rw_member(T& obj, const char* name, const U& value)
 {
@@ -158,6 +335,20 @@ static void test_any()
 	Meta::Any a2(i);
 	assert(a2.GetPointer() != &i);
 	assert(*reinterpret_cast<int*>(a2.GetPointer()) == i);
+
+	// too large for the inline storage
+	std::string s("a string that does not fit in an Any");
+	Meta::Any a3(s);
+	assert(a3.GetReference<std::string>() == s);
+	Meta::Any a4(a3);
+	assert(a4.GetPointer() != a3.GetPointer() && a4.GetReference<std::string>() == s);
+	void* p = a4.GetPointer();
+	Meta::Any a5(std::move(a4));
+	assert(a5.GetPointer() == p && a4.GetType() == nullptr);
+	a2 = a5;
+	assert(a2.GetReference<std::string>() == s);
+	a1 = std::move(a2);
+	assert(a1.GetReference<std::string>() == s && a2.GetType() == nullptr);
 }
 
 static void test_meta()
@@ -187,9 +378,803 @@ static void test_meta()
 	test_method(b, "baz", 10.f, 20.0, (char)7);
 }
 
+static void test_lookup()
+{
+	B b;
+	auto type = Meta::Get(b);
+	ptrdiff_t a2 = reinterpret_cast<char*>(static_cast<A2*>(&b)) - reinterpret_cast<char*>(&b);
+
+	auto e = type->FindMemberEntry("d");
+	assert(e != nullptr && e->item == Meta::Get<A2>()->FindMember("d"));
+	assert(e->offset == a2);
+
+	e = type->FindMemberEntry("c");
+	assert(e != nullptr && e->offset == 0);
+
+	auto m = type->FindMethodEntry("gaz");
+	assert(m != nullptr && m->item->GetOwner() == Meta::Get<A2>());
+	assert(m->offset == a2);
+
+	assert(type->FindMember("missing") == nullptr);
+	assert(type->FindMethod("missing") == nullptr);
+
+	assert(type->IsDerivedFrom(Meta::Get<A1>()) && type->IsDerivedFrom(Meta::Get<A2>()));
+	assert(!type->IsDerivedFrom(type) && type->IsSameOrDerivedFrom(type));
+	assert(!Meta::Get<A2>()->IsSameOrDerivedFrom(type));
+	assert(type->Adjust(Meta::Get<A2>(), &b) == static_cast<A2*>(&b));
+	assert(type->Adjust(Meta::Get<TestC::C>(), &b) == nullptr);
+
+	// a type looked up before its base was defined is completed on a later lookup
+	assert(s_TaggedEarly && Meta::Get<TaggedParticle>()->FindMember("x") != nullptr);
+
+	// types are frozen when defined, so lookups and the ancestor checks of accesses are pure reads that threads may make at once
+	std::vector<std::thread> threads;
+	for (int t = 0; t != 4; ++t)
+	{
+		threads.push_back(std::thread([type, a2, &b]()
+		{
+			auto d = Meta::Get<A2>()->FindMember("d");
+			for (int i = 0; i != 1000; ++i)
+			{
+				assert(type->FindMemberEntry("d")->offset == a2 && type->FindMethod("gaz") != nullptr);
+				assert(type->Adjust(Meta::Get<A2>(), &b) == static_cast<A2*>(&b) && d->CanGet(&b));
+				assert(Meta::Any(&b).GetPointer<A2>() == static_cast<A2*>(&b));
+			}
+		}));
+	}
+	for (auto& t : threads)
+		t.join();
+}
+
+static void test_invoke()
+{
+	B b;
+	b.c = 1.f;
+
+	auto m = Meta::Get(b)->FindMethod("lerp");
+	assert(m != nullptr && m->GetArity() == 3);
+	assert(m->GetParamType(2).type == Meta::Get<float>() && m->GetParamType(3).type == nullptr);
+	Meta::Any argv[3] = { 2.f, 4.f, 0.5f };
+	assert(m->CanCall(&b, 3, argv));
+	assert(m->Call(&b, 3, argv).GetReference<float>() == 3.f);
+
+	assert((m->CanInvoke<float, float, float, float>()));
+	assert((!m->CanInvoke<float, float, float, double>()));
+	assert((m->Invoke<float, float, float, float>(&b, 2.f, 4.f, 0.25f) == 2.5f));
+
+	auto e = Meta::Get(b)->FindMethodEntry("setName");
+	assert((e != nullptr && e->item->CanInvoke<void, const std::string&>()));
+	e->item->Invoke<void, const std::string&>(reinterpret_cast<char*>(&b) + e->offset, std::string("direct"));
+	assert(b.getName() == "direct");
+}
+
+static void test_field()
+{
+	B b;
+	b.c = 2.f;
+	b.setA(7);
+	auto type = Meta::Get(b);
+
+	auto c = type->FindField<float>("c");
+	assert(c.IsValid() && &c.Ref(&b) == &b.c);
+	c.Set(&b, 4.5f);
+	assert(b.c == 4.5f && c.Get(&b) == 4.5f);
+
+	auto a = type->FindField<int>("a");
+	assert(a.IsValid() && a.Get(&b) == 7);
+
+	assert(!type->FindField<int>("d").IsValid()); // getter/setter
+	assert(!type->FindField<int>("c").IsValid()); // wrong type
+	assert(!type->FindField<int>("missing").IsValid());
+}
+
+static void test_static()
+{
+	assert(s_StaticReadyEarly);
+
+	TestD::Body body;
+	body.id = 3;
+	body.x = 1.f;
+	body.mass = 2.f;
+	auto type = Meta::GetStatic<TestD::Body>();
+	assert(std::strcmp(type->name, "TestD::Body") == 0 && type->size == sizeof(TestD::Body));
+
+	auto x = type->FindField<float>("x");
+	assert(x.IsValid() && &x.Ref(&body) == &body.x);
+	assert(type->FindField<int>("id").Get(&body) == 3);
+	assert(type->FindField<std::string>("label").IsValid());
+	assert(s_BodyFields[1].address(&body) == &body.label && s_BodyFields[1].GetOffset() == reinterpret_cast<char*>(&body.label) - reinterpret_cast<char*>(&body));
+	assert(!type->FindField<int>("mass").IsValid() && !type->FindField<float>("missing").IsValid());
+
+	assert(type->IsSameOrDerivedFrom(Meta::GetStatic<TestC::C>()) && !Meta::GetStatic<TestC::C>()->IsSameOrDerivedFrom(type));
+	assert(type->Adjust(Meta::GetStatic<TestC::C>(), &body) == static_cast<TestC::C*>(&body));
+
+	ptrdiff_t offset;
+	auto scaled = type->FindMethod("scaled", offset);
+	assert(scaled != nullptr && offset == 0 && scaled->arity == 1);
+	assert((scaled->CanInvoke<float, float>() && !scaled->CanInvoke<float, double>()));
+	assert((scaled->Invoke<float, float>(&body, 1.5f) == 3.f));
+	type->FindMethod("rename", offset)->Invoke<void, const std::string&>(&body, std::string("static"));
+	assert((&type->FindMethod("getLabel", offset)->Invoke<std::string&>(&body) == &body.label && body.label == "static"));
+	assert(type->FindMethod("missing", offset) == nullptr);
+}
+
+static void test_serialize()
+{
+	auto& serializer = Meta::Serializer::Instance();
+	serializer.SetCodec<std::string>();
+
+	// x and y are adjacent, so a C is written with a single copy
+	auto& plan = serializer.GetPlan(Meta::Get<TestC::C>());
+	assert(plan.size() == 1 && plan[0].kind == Meta::Serializer::Step::Bytes && plan[0].size == sizeof(TestC::C));
+
+	B b;
+	b.setA(5);
+	Meta::Get(b)->FindField<float>("b").Set(&b, 2.5f);
+	b.c = 1.5f;
+	b.setD(77);
+	b.setName("serialized");
+
+	Meta::BufferWriter writer;
+	serializer.Save(writer, b);
+	auto& buffer = writer.GetBuffer();
+
+	B loaded;
+	Meta::BufferReader reader(buffer.data(), buffer.size());
+	assert(serializer.Load(reader, loaded) && reader.GetPosition() == buffer.size());
+	assert(loaded.getA() == 5 && loaded.getB() == 2.5f && loaded.c == 1.5f);
+	assert(loaded.getD() == 77 && loaded.getName() == "serialized");
+
+	Meta::BufferReader truncated(buffer.data(), buffer.size() - 1);
+	assert(!serializer.Load(truncated, loaded));
+
+	// threads race to compile the plan for a Body and all get the same one
+	TestD::Body body;
+	body.mass = 4.f;
+	body.label = "threaded";
+	std::vector<std::thread> threads;
+	for (int i = 0; i != 4; ++i)
+	{
+		threads.push_back(std::thread([&serializer, &body]()
+		{
+			Meta::BufferWriter local;
+			serializer.Save(local, body);
+			TestD::Body copy;
+			Meta::BufferReader input(local.GetBuffer().data(), local.GetBuffer().size());
+			assert(serializer.Load(input, copy) && copy.mass == 4.f && copy.label == "threaded");
+			assert(&serializer.GetPlan(Meta::Get<TestD::Body>()) == &serializer.GetPlan(Meta::Get<TestD::Body>()));
+		}));
+	}
+	for (auto& t : threads)
+		t.join();
+
+	// a value that cannot be saved fails the whole object rather than being left out
+	Resource resource = Resource();
+	auto& incomplete = serializer.GetPlan(Meta::Get<Resource>());
+	assert(!incomplete.IsComplete() && incomplete.GetUnsupported() == Meta::Get<std::vector<int>>());
+	Meta::BufferWriter refused;
+	assert(!serializer.Save(refused, resource) && refused.GetBuffer().empty());
+	assert(!serializer.Load(reader, resource));
+
+	std::stringstream stream;
+	Meta::StreamWriter out(stream);
+	assert(serializer.Save(out, b));
+	B streamed;
+	Meta::StreamReader in(stream);
+	assert(serializer.Load(in, streamed) && streamed.c == 1.5f && streamed.getName() == "serialized");
+}
+
+static void test_hash()
+{
+	assert(Meta::internal::hash_bytes("abc", 3, 0) == 0x44BC2CF5AD770999ULL);
+
+	auto& hasher = Meta::Hasher::Instance();
+	hasher.SetComparer<std::string>();
+
+	// id, x, y and mass are adjacent across both bases, so they are hashed as one run before the string
+	auto& plan = hasher.GetPlan(Meta::Get<TestD::Body>());
+	assert(hasher.CanHash(Meta::Get<TestD::Body>()) && !hasher.CanHash(Meta::Get<Resource>()));
+	assert(plan.size() == 2 && plan[0].kind == Meta::Hasher::Step::Bytes && plan[0].size == sizeof(int) + 3 * sizeof(float));
+	assert(plan[1].kind == Meta::Hasher::Step::Field && plan[1].type == Meta::Get<std::string>());
+
+	TestD::Body a;
+	a.id = 3;
+	a.x = 1.f;
+	a.y = 2.f;
+	a.mass = 10.f;
+	a.label = "hashed";
+	TestD::Body b = a;
+	assert(hasher.Equals(a, b) && hasher.Hash(a) == hasher.Hash(b));
+
+	b.label = "different";
+	assert(!hasher.Equals(a, b) && hasher.Hash(a) != hasher.Hash(b));
+	b.label = a.label;
+	b.y = 3.f;
+	assert(!hasher.Equals(a, b) && hasher.Hash(a) != hasher.Hash(b));
+
+	// members of A2 are reached through getters
+	B b1, b2;
+	b1.setA(1);
+	b2.setA(1);
+	Meta::Get(b1)->FindField<float>("b").Set(&b1, 0.f);
+	Meta::Get(b2)->FindField<float>("b").Set(&b2, 0.f);
+	b1.c = b2.c = 0.f;
+	b1.setD(4);
+	b2.setD(4);
+	b1.setName("same");
+	b2.setName("same");
+	assert(hasher.Equals(b1, b2) && hasher.Hash(b1) == hasher.Hash(b2));
+	b2.setD(5);
+	assert(!hasher.Equals(b1, b2) && hasher.Hash(b1) != hasher.Hash(b2));
+}
+
+static void test_soa()
+{
+	Meta::SoaArray array(Meta::Get<TestD::Body>());
+	assert(array.GetFields().size() == 5); // id, x, y, mass, label
+
+	TestD::Body body;
+	body.id = 1;
+	body.x = 2.f;
+	body.y = 3.f;
+	body.mass = 4.f;
+	body.label = "a label that does not fit in the small string buffer";
+	for (int i = 0; i != 100; ++i)
+	{
+		body.id = i;
+		body.x = (float)i;
+		assert(array.Push(&body) == (size_t)i);
+	}
+
+	auto x = array.GetColumn<float>("x");
+	assert(x.size == 100 && reinterpret_cast<uintptr_t>(x.data) % Meta::Column::Alignment == 0);
+	float sum = 0.f;
+	for (float v : x)
+		sum += v;
+	assert(sum == 4950.f);
+	assert(array.GetColumn<int>("x").empty() && array.GetColumn<float>("missing").empty());
+
+	assert(array.Fill("mass", 0.5f) && !array.Fill("mass", 1));
+	assert(array.ForEach<int>("id", [](int& id) { id *= 2; }));
+	assert(array.Get(7, *array.FindField("id")).GetReference<int>() == 14);
+
+	array.SwapRemove(0);
+	assert(array.GetSize() == 99 && array.GetColumn<int>("id")[0] == 198);
+
+	TestD::Body loaded;
+	array.Load(3, &loaded);
+	assert(loaded.id == 6 && loaded.x == 3.f && loaded.y == 3.f && loaded.mass == 0.5f && loaded.label == body.label);
+
+	loaded.label = "stored";
+	array.Store(3, &loaded);
+	assert(array.GetColumn<std::string>("label")[3] == "stored");
+}
+
+static void test_components()
+{
+	Meta::ComponentStore store;
+	Meta::Entity entities[10];
+	for (int i = 0; i != 10; ++i)
+	{
+		entities[i] = store.Create();
+		TestC::C c = { (float)i, 0.f };
+		store.Add(entities[i], c);
+		if (i % 2 == 0)
+			store.Add(entities[i], TestD::Tag())->id = i;
+		if (i % 3 == 0)
+			store.Add(entities[i], std::string("component string that is too long for small buffers"));
+	}
+
+	int count = 0;
+	store.Each<TestC::C, TestD::Tag>([&](TestC::C& c, TestD::Tag& t) { assert(c.x == (float)t.id); c.y = 1.f; ++count; });
+	assert(count == 5);
+	assert(store.Find<TestC::C>(entities[4])->y == 1.f && store.Find<TestC::C>(entities[5])->y == 0.f);
+	assert(*store.Find<std::string>(entities[6]) == "component string that is too long for small buffers");
+	assert(store.Find<std::string>(entities[4]) == nullptr);
+
+	// structural changes keep the other components
+	store.Remove<TestD::Tag>(entities[0]);
+	store.Remove<TestD::Tag>(entities[6]);
+	assert(store.Find<TestD::Tag>(entities[0]) == nullptr && store.Find<TestC::C>(entities[0])->x == 0.f);
+	assert(store.Find<TestC::C>(entities[6])->x == 6.f && store.Find<std::string>(entities[6])->size() > 16);
+	assert(store.Find<TestD::Tag>(entities[8])->id == 8);
+	count = 0;
+	store.Each<TestD::Tag>([&](TestD::Tag&) { ++count; });
+	assert(count == 3);
+
+	store.Destroy(entities[3]);
+	assert(!store.IsAlive(entities[3]) && store.Find<TestC::C>(entities[3]) == nullptr);
+	Meta::Entity reused = store.Create();
+	assert(reused.index == entities[3].index && reused != entities[3] && store.Find<TestC::C>(reused) == nullptr);
+	assert(*store.Find<std::string>(entities[9]) == "component string that is too long for small buffers");
+}
+
+static void test_script()
+{
+	typedef Meta::Instruction I;
+
+	// calls gar(0.5) ten times in a loop, then returns c
+	// r0 = object, r1 = counter, r2 = limit, r3 = step, r4 = condition, r5 = argument, r6 = result
+	Meta::Script script;
+	const int gar = script.AddSite("gar", 1);
+	const int c = script.AddSite("c");
+	script.Emit(I::Load, 1, script.AddConstant(0));
+	script.Emit(I::Load, 2, script.AddConstant(10));
+	script.Emit(I::Load, 3, script.AddConstant(1));
+	script.Emit(I::Load, 5, script.AddConstant(0.5f));
+	const int loop = script.Emit(I::Less, 4, 1, 2);
+	const int exit = script.Emit(I::JumpIfZero, 4);
+	script.Emit(I::Call, 6, 0, gar, 5);
+	script.Emit(I::Add, 1, 1, 3);
+	script.Emit(I::Jump, loop);
+	script.Patch(exit, script.GetNext());
+	script.Emit(I::GetMember, 6, 0, c);
+	script.Emit(I::Return, 6);
+
+	B b;
+	b.c = 1.f;
+	Meta::Interpreter interpreter;
+	Meta::Any result;
+	Meta::Any args[2] = { &b, 2.5f };
+	assert(interpreter.Run(script, 1, args, result) && result.GetReference<float>() == 6.f && b.c == 6.f);
+	assert(script.GetSite(gar).count == 1 && script.GetSite(c).count == 1);
+
+	// one site sees two receiver types, with x in a base of one of them
+	Meta::Script getX;
+	const int x = getX.AddSite("x");
+	getX.Emit(I::GetMember, 1, 0, x);
+	getX.Emit(I::Return, 1);
+
+	TestC::C point = { 3.f, 4.f };
+	TestD::Body body;
+	body.x = 7.f;
+	Meta::Any receivers[2] = { &point, &body };
+	assert(interpreter.Run(getX, 1, &receivers[0], result) && result.GetReference<float>() == 3.f);
+	assert(interpreter.Run(getX, 1, &receivers[1], result) && result.GetReference<float>() == 7.f);
+	assert(interpreter.Run(getX, 1, &receivers[0], result) && result.GetReference<float>() == 3.f);
+	assert(getX.GetSite(x).count == 2 && !getX.GetSite(x).megamorphic);
+	assert(!interpreter.Run(getX, 1, args, result) && interpreter.GetError() != nullptr);
+
+	Meta::Script setC;
+	setC.Emit(I::SetMember, 0, 1, setC.AddSite("c"));
+	assert(interpreter.Run(setC, 2, args, result) && b.c == 2.5f);
+}
+
+static void test_batch()
+{
+	B objs[100];
+	for (auto& b : objs)
+		b.c = 1.f;
+
+	// shared argument, with the results collected
+	auto gar = Meta::Get<B>()->FindMethod("gar");
+	Meta::Any shared = 2.f;
+	Meta::Any results[100];
+	assert(gar->CallBatch(objs, 100, 1, &shared, 0, results));
+	assert(objs[0].c == 3.f && objs[99].c == 3.f && results[99].GetReference<float>() == 3.f);
+
+	// an argument per object, split across threads
+	Meta::Any each[100];
+	for (int i = 0; i != 100; ++i)
+		each[i] = float(i);
+	assert(gar->CallBatch(objs, 100, 1, each, 1, nullptr, 4));
+	for (int i = 0; i != 100; ++i)
+		assert(objs[i].c == 3.f + i);
+
+	// two threads split their halves at once, sharing the kept workers
+	std::thread other([&]() { assert(gar->CallBatch(objs, 50, 1, &shared, 0, nullptr, 4)); });
+	assert(gar->CallBatch(objs + 50, 50, 1, &shared, 0, nullptr, 4));
+	other.join();
+	for (int i = 0; i != 100; ++i)
+		assert(objs[i].c == 5.f + i);
+
+	// asking for more threads than the hardware has uses no more than it has
+	assert(gar->CallBatch(objs, 100, 1, &shared, 0, nullptr, 1000));
+	for (int i = 0; i != 100; ++i)
+		assert(objs[i].c == 7.f + i);
+
+	// a method of a base that is not at offset 0
+	auto setName = Meta::Get<A2>()->FindMethod("setName");
+	Meta::Any name = std::string("batch");
+	assert(setName->CallBatch(objs, 100, 1, &name));
+	assert(objs[0].getName() == "batch" && objs[99].getName() == "batch");
+
+	// nothing is called if any argument is wrong
+	each[50] = 1;
+	assert(!gar->CallBatch(objs, 100, 1, each, 1));
+	assert(objs[0].c == 7.f);
+	assert(!setName->CallBatch(Meta::Get<TestC::C>(), objs, 100, sizeof(B), 1, &name));
+}
+
+static void test_tween()
+{
+	B b;
+	b.c = 0.f;
+	TestD::Body body;
+	body.x = body.y = 0.f;
+
+	Meta::Tweener tweener;
+	assert(tweener.Add(b, "c", 0.f, 10.f, 1.f));
+	assert(tweener.Add(b, "b", 4.f, 0.f, 2.f, Meta::Tweener::QuadIn));
+	assert(tweener.Add(body, "x", 1.f, 3.f, 1.f, Meta::Tweener::SmoothStep));
+	assert(tweener.Add(body, "y", 0.f, 1.f, 4.f));
+	assert(!tweener.Add(b, "a", 0.f, 1.f, 1.f)); // not a float
+	assert(!tweener.Add(b, "d", 0.f, 1.f, 1.f)); // accessed through functions
+	assert(tweener.GetCount() == 4);
+
+	tweener.Update(0.5f);
+	assert(b.c == 5.f && b.getB() == 3.75f && body.x == 2.f && body.y == 0.125f);
+
+	tweener.Update(0.5f);
+	assert(b.c == 10.f && b.getB() == 3.f && body.x == 3.f && tweener.GetCount() == 2);
+
+	tweener.Cancel(Meta::Get<TestD::Body>(), &body);
+	assert(tweener.GetCount() == 1);
+	tweener.Update(2.f);
+	assert(b.getB() == 0.f && body.y == 0.25f && tweener.GetCount() == 0);
+
+	// a finished tween lands exactly on its end value, however far away it started
+	assert(tweener.Add(b, "c", 1e8f, 1.f, 1.f));
+	tweener.Update(1.f);
+	assert(b.c == 1.f && tweener.GetCount() == 0);
+}
+
+static void test_actions()
+{
+	B b;
+	b.setA(2);
+	b.setD(0);
+	b.c = 0.f;
+	TestD::Body body;
+	body.x = 0.f;
+
+	// lane 1 waits, calls foo, tweens c and then sets a; lane 2 runs alongside it
+	Meta::ActionList list;
+	assert(list.Wait(1, 0.5f));
+	assert(list.Call(1, b, "foo"));
+	assert(list.Tween(1, b, "c", 0.f, 10.f, 1.f));
+	assert(list.Set(1, b, "a4", Meta::Any(7)));
+	assert(list.Set(2, b, "d", Meta::Any(5)));
+	assert(list.Tween(2, body, "x", 0.f, 1.f, 2.f, Meta::Tweener::Linear, false));
+	assert(list.Set(2, body, "mass", Meta::Any(3.f)));
+	assert(list.GetCount() == 7);
+
+	const Meta::Any args[3] = { Meta::Any(1.f), Meta::Any(3.f), Meta::Any(0.5f) };
+	assert(list.Call(4, b, "lerp", 3, args));
+	assert(!list.Call(4, b, "lerp", 2, args)); // wrong arity
+	assert(!list.Call(4, b, "missing"));
+	assert(!list.Set(4, b, "a2", Meta::Any(1))); // read-only
+	assert(!list.Tween(4, b, "a", 0.f, 1.f, 1.f)); // not a float
+	assert(!list.Wait(0, 1.f));
+	assert(list.GetCount() == 8);
+
+	// the non-blocking tween lets the set after it run at once
+	list.Update(0.25f);
+	assert(b.getA() == 2 && b.getD() == 5 && body.x == 0.125f && body.mass == 3.f && list.GetCount() == 5);
+
+	// the wait finishes, so foo runs and the tween starts in the same update
+	list.Update(0.25f);
+	assert(b.getA() == 6 && b.c == 2.5f && body.x == 0.25f && list.GetCount() == 3);
+
+	list.Update(0.5f);
+	assert(b.c == 7.5f && b.getA() == 6);
+
+	list.Update(0.25f);
+	assert(b.c == 10.f && b.getA() == 7 && list.GetCount() == 1);
+
+	list.Cancel(2);
+	assert(list.GetCount() == 0);
+	list.Update(1.f);
+	assert(body.x == 0.625f);
+
+	assert(list.Tween(1, b, "c", 1e8f, 1.f, 1.f));
+	list.Update(1.f);
+	assert(b.c == 1.f && list.GetCount() == 0);
+}
+
+// tests that over-aligned values stay aligned in Anys and through members and methods
+template <typename Type> static bool is_aligned(const void* ptr) { return reinterpret_cast<uintptr_t>(ptr) % std::alignment_of<Type>::value == 0; }
+
+static void test_aligned()
+{
+	const Vec4 v = { 1.f, 2.f, 3.f, 4.f };
+	Mat4 m = Mat4();
+	m.m[12] = 10.f;
+
+	Meta::Any av(v), am(m);
+	assert(is_aligned<Vec4>(av.GetPointer()) && is_aligned<Mat4>(am.GetPointer()));
+#if META_ANY_ALIGNMENT >= 16
+	static_assert(Meta::internal::any_is_inline<Vec4>::value, "a vec4 should be stored inline");
+#endif
+	static_assert(!Meta::internal::any_is_inline<Mat4>::value, "a 32-byte aligned mat4 should be pooled");
+
+	// copies and moves, including into heap storage, keep the alignment
+	std::vector<Meta::Any> values(3, av);
+	values.push_back(am);
+	values.push_back(std::move(av));
+	for (auto& a : values)
+		assert(a.GetType() == Meta::Get<Vec4>() ? is_aligned<Vec4>(a.GetPointer()) : is_aligned<Mat4>(a.GetPointer()));
+
+	Transform t = Transform();
+	auto type = Meta::Get<Transform>();
+	auto position = type->FindMember("position");
+	auto world = type->FindMember("world");
+	position->Set(&t, values[0]);
+	world->Set(&t, am);
+	assert(t.position.y == 2.f && t.world.m[12] == 10.f);
+
+	Meta::Any p = position->Get(&t);
+	Meta::Any w = world->Get(&t);
+	assert(is_aligned<Vec4>(p.GetPointer()) && p.GetReference<Vec4>().w == 4.f);
+	assert(is_aligned<Mat4>(w.GetPointer()) && w.GetReference<Mat4>().m[12] == 10.f);
+
+	Meta::Any r = type->FindMethod("apply")->Call(&t, 1, &values[1]);
+	assert(is_aligned<Vec4>(r.GetPointer()) && r.GetReference<Vec4>().x == 11.f);
+
+	// a thread's pooled blocks are released when it exits
+	std::thread([&m] { Meta::Any a(m); assert(is_aligned<Mat4>(a.GetPointer())); }).join();
+
+	// each size class caches a bounded number of blocks; the rest go back to the heap
+	{
+		std::vector<Meta::Any> many(1000, Meta::Any(m));
+	}
+	assert(Meta::internal::AnyPool::GetCached(sizeof(Mat4)) == Meta::internal::AnyPool::MaxCached);
+	Meta::internal::AnyPool::Trim();
+	assert(Meta::internal::AnyPool::GetCached(sizeof(Mat4)) == 0);
+
+	Meta::Column column(Meta::Get<Mat4>());
+	column.Push(&m);
+	assert(is_aligned<Mat4>(column.GetData()));
+}
+
+static void test_migrate()
+{
+	auto& registry = Meta::Registry::Instance();
+	auto from = registry.Find("Unit");
+	auto to = registry.FindLatest("Unit");
+	assert(from == Meta::Get<V1::Unit>() && to == Meta::Get<V2::Unit>());
+
+	// id and speed are one run; hp is converted from float to double; name is assigned; pos is copied whole
+	typedef Meta::Migrator::Step Step;
+	auto& plan = Meta::Migrator::Instance().GetPlan(from, to);
+	assert(plan.size() == 4);
+	assert(plan[0].kind == Step::Copy && plan[0].size == sizeof(int) + sizeof(float));
+	assert(plan[1].kind == Step::Convert && plan[2].kind == Step::Assign && plan[3].kind == Step::Copy);
+
+	V1::Unit old[3];
+	for (int i = 0; i != 3; ++i)
+	{
+		old[i].id = i;
+		old[i].speed = 2.f * i;
+		old[i].hp = 100.5f;
+		old[i].name = "unit";
+		old[i].pos.x = 1.f;
+		old[i].pos.y = float(i);
+	}
+
+	alignas(V2::Unit) char storage[3 * sizeof(V2::Unit)];
+	assert(Meta::Migrator::Instance().Migrate(from, to, old, sizeof(V1::Unit), storage, sizeof(V2::Unit), 3));
+	V2::Unit* units = reinterpret_cast<V2::Unit*>(storage);
+	for (int i = 0; i != 3; ++i)
+	{
+		assert(units[i].id == i && units[i].speed == 2.f * i && units[i].hp == 100.5);
+		assert(units[i].name == "unit" && units[i].pos.x == 1.f && units[i].pos.y == float(i));
+		assert(units[i].armor == 5.f);
+		units[i].~Unit();
+	}
+}
+
+static void test_layout()
+{
+	// 7 bytes after alive, 7 after kind and 4 at the end
+	auto type = Meta::Get<Particle>();
+	Meta::Layout layout(type);
+	auto& fields = layout.GetFields();
+	assert(fields.size() == 5 && std::strcmp(fields[1].member->GetName(), "x") == 0 && fields[1].offset == 8);
+	assert(layout.GetGaps().size() == 3 && layout.GetGapBytes() == sizeof(Particle) - 2 * sizeof(char) - 2 * sizeof(double) - sizeof(float));
+
+	size_t size;
+	auto order = layout.SuggestOrder(size);
+	assert(size == 24 && size < sizeof(Particle));
+	assert(std::strcmp(order[0]->GetName(), "x") == 0 && std::strcmp(order[2]->GetName(), "life") == 0 && std::strcmp(order[4]->GetName(), "kind") == 0);
+
+	Meta::Layout::Accesses accesses;
+	accesses[type->FindMember("x")] = 100;
+	accesses[type->FindMember("y")] = 100;
+	accesses[type->FindMember("life")] = 10;
+	layout.SetAccesses(accesses);
+	std::vector<const Meta::Layout::Field*> hot, cold;
+	layout.SplitHotCold(0.9, hot, cold);
+	assert(hot.size() == 2 && cold.size() == 3 && std::strcmp(cold[0]->member->GetName(), "life") == 0);
+
+	std::stringstream dump;
+	layout.Dump(dump);
+	assert(dump.str().find("suggested order: x y life alive kind") != std::string::npos);
+
+	// inherited members are found at the offsets of their bases; the vtable pointer of A1 and all of A2, which has
+	// only accessor members, are gaps
+	B b;
+	const ptrdiff_t a2 = reinterpret_cast<char*>(static_cast<A2*>(&b)) - reinterpret_cast<char*>(&b);
+	Meta::Layout derived(Meta::Get<B>());
+	assert(derived.GetBases().size() == 2 && derived.GetBases()[1].type == Meta::Get<A2>() && derived.GetBases()[1].offset == a2);
+	assert(derived.GetFields().size() == 3 && derived.GetFields()[0].inherited && !derived.GetFields()[2].inherited);
+	assert(derived.GetGaps()[0].offset == 0 && derived.GetGaps()[0].size == sizeof(void*));
+	assert(derived.GetGaps()[1].offset == a2 && derived.GetGaps()[1].size == sizeof(A2));
+
+	// the 64-byte matrix starts half way into the first line
+	Meta::Layout transform(Meta::Get<Transform>());
+	assert(transform.GetLineCount() == 2 && !transform.GetFields()[0].crossesLine && transform.GetFields()[1].crossesLine);
+}
+
+static void test_database()
+{
+	Meta::BufferWriter writer;
+	Meta::Database::Export(writer);
+	const std::vector<char>& buffer = writer.GetBuffer();
+
+	Meta::Database db;
+	assert(db.Open(buffer.data(), buffer.size()));
+	assert(db.GetTypeCount() == Meta::Registry::Instance().GetTypes().size());
+
+	auto b = db.FindType("B");
+	assert(b != nullptr && b->size == sizeof(B) && b->baseCount == 2);
+	assert(std::strcmp(db.GetName(*db.GetType(db.GetBase(*b, 1)->type)), "A2") == 0);
+	assert(db.FindType("missing") == nullptr);
+
+	// the first definition of a name wins, as in Registry::Find
+	auto unit = db.FindType("Unit");
+	assert(unit != nullptr && unit->size == sizeof(V1::Unit) && unit->memberCount == 5);
+
+	// inherited members report the offset of their owner, and accessor members have none of their own
+	B obj;
+	ptrdiff_t offset;
+	auto d = db.FindMember(*b, "d", offset);
+	assert(d != nullptr && d->offset == -1 && d->isMutable == 1);
+	assert(offset == reinterpret_cast<char*>(static_cast<A2*>(&obj)) - reinterpret_cast<char*>(&obj));
+	assert(std::strcmp(db.GetName(*db.GetType(d->owner)), "A2") == 0);
+	auto c = db.FindMember(*b, "c", offset);
+	assert(c != nullptr && offset == 0 && c->offset == reinterpret_cast<char*>(&obj.c) - reinterpret_cast<char*>(&obj));
+	assert(db.FindMember(*b, "a3")->isMutable == 0 && db.FindMember(*b, "missing") == nullptr);
+
+	auto lerp = db.FindMethod(*b, "lerp");
+	assert(lerp != nullptr && lerp->arity == 3);
+	assert(std::strcmp(db.GetName(*db.GetType(db.GetReturn(*lerp)->type)), "float") == 0);
+	assert(db.GetParam(*lerp, 2)->type == db.GetIndex(*db.FindType("float")));
+	auto setName = db.FindMethod(*b, "setName");
+	assert(db.GetReturn(*setName)->type == Meta::Database::None && db.GetParam(*setName, 0)->qualifier == Meta::TypeRecord::ConstPointer);
+
+	// damaged or foreign data is rejected
+	assert(!db.Open(buffer.data(), buffer.size() - 4) && !db.IsOpen());
+	std::vector<char> damaged(buffer);
+	damaged[0] = 'X';
+	assert(!db.Open(damaged.data(), damaged.size()));
+
+	// the same lookups work on a mapped file
+	const char* path = "MetaTest.mtdb";
+	{
+		std::ofstream file(path, std::ios::binary);
+		Meta::StreamWriter stream(file);
+		Meta::Database::Export(stream);
+	}
+	assert(db.Open(path) && db.FindMember(*db.FindType("B"), "d", offset) != nullptr);
+	db.Close();
+	std::remove(path);
+	assert(!db.Open(path));
+}
+
+#if META_PROFILE
+static void test_profile()
+{
+	auto& profiler = Meta::Profiler::Instance();
+	profiler.Reset();
+
+	B b;
+	auto type = Meta::Get(b);
+	for (int i = 0; i != 40; ++i)
+	{
+		type->FindMember("c");
+		type->FindMember("missing");
+	}
+	type->FindMember("c")->Set(&b, Meta::Any(1.f));
+	Meta::Any argv[1] = { 2.f };
+	type->FindMethod("gar")->Call(&b, 1, argv);
+
+	// counters are kept per thread and name pointer, and merged by name, including those of threads that have exited
+	std::thread([type]()
+	{
+		for (int i = 0; i != 5; ++i)
+			type->FindMember("missing");
+	}).join();
+	char missing[] = "missing";
+	type->FindMember(missing);
+
+	unsigned long long hits = 0, misses = 0, sets = 0, calls = 0, anys = 0, samples = 0;
+	profiler.Each([&](const Meta::TypeInfo* t, const char* name, Meta::Profiler::Event event, const Meta::Profiler::Counter& c)
+	{
+		const bool isB = t == type;
+		if (isB && std::strcmp(name, "c") == 0 && event == Meta::Profiler::FindMemberHit)
+			hits = c.count;
+		else if (isB && std::strcmp(name, "missing") == 0 && event == Meta::Profiler::FindMemberMiss)
+			misses = c.count;
+		else if (isB && std::strcmp(name, "c") == 0 && event == Meta::Profiler::MemberSet)
+			sets = c.count;
+		else if (isB && std::strcmp(name, "gar") == 0 && event == Meta::Profiler::MethodCall)
+			calls = c.count;
+		else if (t == Meta::Get<float>() && event == Meta::Profiler::AnyConstruct)
+			anys = c.count;
+		samples += c.samples;
+	});
+	assert(hits == 41 && misses == 46 && sets == 1 && calls == 1 && anys >= 2 && samples != 0);
+
+	std::stringstream dump;
+	profiler.Dump(dump);
+	assert(dump.str().find("B\tmissing\tfind member miss\t46") != std::string::npos);
+
+	auto accesses = Meta::Layout::GetProfiledAccesses();
+	assert(accesses[type->FindMember("c")] == 1);
+	profiler.Reset();
+}
+#endif
+
+static void test_concurrent_find()
+{
+	// the first lookups build the name index, so every thread may find it out of date at once
+	auto& registry = Meta::Registry::Instance();
+	std::vector<std::thread> threads;
+	for (int i = 0; i != 4; ++i)
+	{
+		threads.emplace_back([&registry]
+		{
+			for (int j = 0; j != 100; ++j)
+			{
+				assert(registry.Find("B") == Meta::Get<B>());
+				assert(registry.Find("missing") == nullptr);
+			}
+		});
+	}
+	for (auto& t : threads)
+		t.join();
+}
+
+static void test_registry()
+{
+	auto& registry = Meta::Registry::Instance();
+	assert(registry.Find("B") == Meta::Get<B>());
+	assert(registry.Find("C") == Meta::Get<TestC::C>());
+	assert(registry.Find("string") == Meta::Get<std::string>());
+	assert(registry.Find("int") == Meta::Get<int>());
+	assert(registry.Find("missing") == nullptr);
+	assert(std::strcmp(Meta::Get<TestC::C>()->GetName(), "C") == 0);
+
+	registry.Clear();
+	assert(registry.GetTypes().empty() && registry.Find("B") == nullptr);
+	assert(Meta::Get<B>()->FindMember("c") == nullptr);
+}
+
 // test routine
 int main(int argc, char* argv[])
 {
+	test_concurrent_find(); // before any other lookup, so the threads race to build the index
 	test_any();
 	test_meta();
+	test_lookup();
+	test_invoke();
+	test_field();
+	test_aligned();
+	test_static();
+	test_serialize();
+	test_hash();
+	test_soa();
+	test_components();
+	test_script();
+	test_batch();
+	test_tween();
+	test_actions();
+	test_migrate();
+	test_layout();
+	test_database();
+#if META_PROFILE
+	test_profile();
+#endif
+	test_registry(); // tears down the type system, so must be last
 }
\ No newline at end of file